@@ -0,0 +1,15 @@
+#version 330 core
+
+uniform sampler2D font;
+
+in vec2 uv;
+in vec4 glyph_fg_color;
+in vec4 glyph_bg_color;
+
+out vec4 color;
+
+void main()
+{
+    float coverage = texture(font, uv).r;
+    color = mix(glyph_bg_color, glyph_fg_color, coverage);
+}
@@ -1,5 +1,41 @@
 #version 330 core
 
-void main(){
-    
-}
\ No newline at end of file
+uniform vec2 resolution;
+uniform vec2 camera;
+uniform vec2 glyph_size;
+uniform int atlas_cols;
+uniform vec2 atlas_cell_uv;
+uniform vec2 atlas_pad_uv;
+
+layout(location = 0) in ivec2 tile;
+layout(location = 1) in int ch;
+layout(location = 2) in vec4 fg_color;
+layout(location = 3) in vec4 bg_color;
+
+out vec2 uv;
+out vec4 glyph_fg_color;
+out vec4 glyph_bg_color;
+
+#define ASCII_DISPLAY_LOW 32
+#define ASCII_DISPLAY_HIGH 126
+
+void main()
+{
+    vec2 corner = vec2(float(gl_VertexID & 1), float((gl_VertexID >> 1) & 1));
+
+    vec2 screen = (vec2(tile) + corner) * glyph_size - camera + resolution * 0.5;
+    gl_Position = vec4(2.0 * screen.x / resolution.x - 1.0,
+                       1.0 - 2.0 * screen.y / resolution.y,
+                       0.0, 1.0);
+
+    int index = ch;
+    if (index < ASCII_DISPLAY_LOW || index > ASCII_DISPLAY_HIGH) {
+        index = 63; // '?'
+    }
+    index -= ASCII_DISPLAY_LOW;
+    vec2 cell = vec2(float(index % atlas_cols), float(index / atlas_cols));
+    uv = cell * atlas_cell_uv + atlas_pad_uv + corner * (atlas_cell_uv - 2.0 * atlas_pad_uv);
+
+    glyph_fg_color = fg_color;
+    glyph_bg_color = bg_color;
+}
@@ -0,0 +1,21 @@
+#version 330 core
+
+uniform sampler2D font;
+
+in vec2 uv;
+in vec4 glyph_fg_color;
+in vec4 glyph_bg_color;
+
+out vec4 color;
+
+// Texels store the signed distance to the outline, 128 on the edge.
+#define SDF_EDGE (128.0 / 255.0)
+
+void main()
+{
+    float distance = texture(font, uv).r - SDF_EDGE;
+    // Antialias over one screen pixel whatever the zoom.
+    float width = max(fwidth(distance), 1e-4);
+    float coverage = smoothstep(-width, width, distance);
+    color = mix(glyph_bg_color, glyph_fg_color, coverage);
+}
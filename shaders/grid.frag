@@ -0,0 +1,58 @@
+#version 330 core
+
+uniform sampler2D font;
+uniform usampler2D grid;
+
+uniform vec2 resolution;
+uniform vec2 origin;
+uniform vec2 glyph_size;
+uniform ivec2 grid_size;
+uniform int atlas_cols;
+uniform vec2 atlas_cell_uv;
+
+out vec4 color;
+
+#define ASCII_DISPLAY_LOW 32
+#define ASCII_DISPLAY_HIGH 126
+
+#define GRID_GLYPH_ATTR_INVERSE 1u
+
+const vec4 fg_color = vec4(1.0, 1.0, 1.0, 1.0);
+const vec4 bg_color = vec4(0.0, 0.0, 0.0, 1.0);
+
+void main()
+{
+    vec2 pixel = vec2(gl_FragCoord.x, resolution.y - gl_FragCoord.y);
+    vec2 cell_pos = (pixel - origin) / glyph_size;
+    ivec2 cell = ivec2(floor(cell_pos));
+
+    if (cell.x < 0 || cell.y < 0 || cell.x >= grid_size.x || cell.y >= grid_size.y) {
+        color = bg_color;
+        return;
+    }
+
+    uint value = texelFetch(grid, cell, 0).r;
+    int ch = int(value & 0xffffu);
+    uint attrs = value >> 16;
+
+    if (ch == 0) {
+        color = bg_color;
+        return;
+    }
+    if (ch < ASCII_DISPLAY_LOW || ch > ASCII_DISPLAY_HIGH) {
+        ch = 63; // '?'
+    }
+
+    int index = ch - ASCII_DISPLAY_LOW;
+    vec2 atlas_cell = vec2(float(index % atlas_cols), float(index / atlas_cols));
+    vec2 uv = (atlas_cell + fract(cell_pos)) * atlas_cell_uv;
+    float coverage = texture(font, uv).r;
+
+    vec4 fg = fg_color;
+    vec4 bg = bg_color;
+    if ((attrs & GRID_GLYPH_ATTR_INVERSE) != 0u) {
+        fg = bg_color;
+        bg = fg_color;
+    }
+    color = mix(bg, fg, coverage);
+}
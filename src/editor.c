@@ -1,10 +1,16 @@
 #include "editor.h"
+#include "profiler.h"
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <errno.h>
+#include <SDL2/SDL.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define ASSERT_WITH_MSG(expr, fmt, ...)                       \
     do                                                        \
@@ -22,11 +28,23 @@
 #define EDITOR_INIT_CAPACITY 128
 #define EDITOR_LOAD_CAPACITY 640 * 1024
 
+#define EDITOR_SAVE_BLOCK_SIZE (4 * 1024 * 1024)
+#define EDITOR_SAVE_PARALLEL_THRESHOLD (4 * EDITOR_SAVE_BLOCK_SIZE)
+#define EDITOR_SAVE_MAX_WORKERS 16
+#define EDITOR_SAVE_SLOTS_PER_WORKER 2
+
 #define SV_IMPLEMENTATION
 #include "./sv.h"
 
 static void editor_create_first_new_line(Editor *editor);
 
+static uint64_t line_version_counter = 0;
+
+static void line_touch(Line *line)
+{
+    line->version = ++line_version_counter;
+}
+
 static void line_grow(Line *line, size_t n)
 {
     size_t new_capacity = line->capacity;
@@ -49,6 +67,7 @@ static void line_grow(Line *line, size_t n)
         return;
     }
     line->chars = (char *)realloc(line->chars, new_capacity);
+    profiler_count(PROFILER_COUNTER_ALLOCATIONS, 1);
     line->capacity = new_capacity;
 }
 
@@ -82,6 +101,7 @@ void line_insert_text_before_sized(Line *line, const char *text, size_t text_siz
     memcpy(line->chars + *col, text, text_size);
     line->size += text_size;
     *col += text_size;
+    line_touch(line);
 }
 
 void line_backspace(Line *line, size_t *col)
@@ -96,6 +116,7 @@ void line_backspace(Line *line, size_t *col)
         memmove(line->chars + *col - 1, line->chars + *col, line->size - *col);
         line->size -= 1;
         *col -= 1;
+        line_touch(line);
     }
 }
 void line_delete(Line *line, size_t *col)
@@ -110,6 +131,7 @@ void line_delete(Line *line, size_t *col)
     {
         memmove(line->chars + *col, line->chars + *col + 1, line->size - *col - 1);
         line->size -= 1;
+        line_touch(line);
     }
 }
 
@@ -135,6 +157,7 @@ static void editor_grow(Editor *editor, size_t n)
         return;
     }
     editor->lines = (Line *)realloc(editor->lines, new_capacity * sizeof(editor->lines[0]));
+    profiler_count(PROFILER_COUNTER_ALLOCATIONS, 1);
     editor->capacity = new_capacity;
 }
 
@@ -203,24 +226,373 @@ const char *editor_char_under_cursor(const Editor *editor)
     return NULL;
 }
 
+// Decodes one codepoint and returns the number of bytes it took. Malformed
+// input decodes to U+FFFD one byte at a time so rendering never stalls.
+size_t utf8_decode(const char *text, size_t text_size, uint32_t *codepoint)
+{
+    assert(text_size > 0);
+    const unsigned char *s = (const unsigned char *)text;
+
+    size_t n = 0;
+    uint32_t cp = 0;
+    if (s[0] < 0x80)
+    {
+        *codepoint = s[0];
+        return 1;
+    }
+    else if ((s[0] & 0xe0) == 0xc0)
+    {
+        n = 2;
+        cp = s[0] & 0x1f;
+    }
+    else if ((s[0] & 0xf0) == 0xe0)
+    {
+        n = 3;
+        cp = s[0] & 0x0f;
+    }
+    else if ((s[0] & 0xf8) == 0xf0)
+    {
+        n = 4;
+        cp = s[0] & 0x07;
+    }
+
+    if (n == 0 || n > text_size)
+    {
+        *codepoint = 0xfffd;
+        return 1;
+    }
+    for (size_t i = 1; i < n; ++i)
+    {
+        if ((s[i] & 0xc0) != 0x80)
+        {
+            *codepoint = 0xfffd;
+            return 1;
+        }
+        cp = (cp << 6) | (s[i] & 0x3f);
+    }
+
+    *codepoint = cp;
+    return n;
+}
+
+size_t utf8_count(const char *text, size_t text_size)
+{
+    size_t count = 0;
+    size_t i = 0;
+    while (i < text_size)
+    {
+        uint32_t codepoint;
+        i += utf8_decode(text + i, text_size - i, &codepoint);
+        count += 1;
+    }
+    return count;
+}
+
+// Byte offset just past the first `codepoints` codepoints of the text.
+size_t utf8_advance(const char *text, size_t text_size, size_t codepoints)
+{
+    size_t i = 0;
+    while (i < text_size && codepoints > 0)
+    {
+        uint32_t codepoint;
+        i += utf8_decode(text + i, text_size - i, &codepoint);
+        codepoints -= 1;
+    }
+    return i;
+}
+
+static String_View line_ending_sv(Line_Ending line_ending)
+{
+    switch (line_ending)
+    {
+    case LINE_ENDING_CRLF:
+        return SV("\r\n");
+    case LINE_ENDING_LF:
+    default:
+        return SV("\n");
+    }
+}
+
+typedef struct
+{
+    char *data;
+    size_t size;
+    size_t capacity;
+    bool ready;
+} Save_Block;
+
+// Lines are joined by the buffer's line ending. A file that ended with a line
+// break was loaded with an empty last line, so the round trip is exact.
+//
+// Lines [block_rows[i], block_rows[i + 1]) are serialized into block i.
+// Workers claim blocks in order and fill them into a ring of slots, the
+// writer drains the slots in the same order, so at most slots_count blocks
+// are in memory at any time.
+typedef struct
+{
+    const Editor *editor;
+    size_t *block_rows;
+    size_t blocks_count;
+    Save_Block slots[EDITOR_SAVE_MAX_WORKERS * EDITOR_SAVE_SLOTS_PER_WORKER];
+    size_t slots_count;
+    size_t next_block;
+    size_t written_blocks;
+    SDL_mutex *mutex;
+    SDL_cond *cond;
+} Save_Job;
+
+static void save_block_serialize(Save_Block *block, const Editor *editor, size_t begin, size_t end)
+{
+    const String_View ending = line_ending_sv(editor->line_ending);
+
+    size_t size = 0;
+    for (size_t row = begin; row < end; ++row)
+    {
+        size += editor->lines[row].size;
+        if (row + 1 < editor->size)
+        {
+            size += ending.count;
+        }
+    }
+
+    if (size > block->capacity)
+    {
+        block->data = (char *)realloc(block->data, size);
+        assert(block->data != NULL);
+        block->capacity = size;
+    }
+
+    char *out = block->data;
+    for (size_t row = begin; row < end; ++row)
+    {
+        const Line *line = &editor->lines[row];
+        memcpy(out, line->chars, line->size);
+        out += line->size;
+        if (row + 1 < editor->size)
+        {
+            memcpy(out, ending.data, ending.count);
+            out += ending.count;
+        }
+    }
+    block->size = size;
+}
+
+static int save_job_worker(void *data)
+{
+    Save_Job *job = (Save_Job *)data;
+
+    SDL_LockMutex(job->mutex);
+    for (;;)
+    {
+        while (job->next_block < job->blocks_count &&
+               job->next_block >= job->written_blocks + job->slots_count)
+        {
+            SDL_CondWait(job->cond, job->mutex);
+        }
+
+        if (job->next_block >= job->blocks_count)
+        {
+            break;
+        }
+
+        const size_t index = job->next_block++;
+        Save_Block *block = &job->slots[index % job->slots_count];
+        SDL_UnlockMutex(job->mutex);
+
+        save_block_serialize(block, job->editor, job->block_rows[index], job->block_rows[index + 1]);
+
+        SDL_LockMutex(job->mutex);
+        block->ready = true;
+        SDL_CondBroadcast(job->cond);
+    }
+    SDL_UnlockMutex(job->mutex);
+
+    return 0;
+}
+
+static size_t save_job_split_blocks(Save_Job *job)
+{
+    const Editor *editor = job->editor;
+    const size_t ending_size = line_ending_sv(editor->line_ending).count;
+
+    size_t capacity = 16;
+    job->block_rows = (size_t *)malloc(capacity * sizeof(job->block_rows[0]));
+    assert(job->block_rows != NULL);
+    job->block_rows[0] = 0;
+    job->blocks_count = 0;
+
+    size_t total = 0;
+    size_t block_size = 0;
+    for (size_t row = 0; row < editor->size; ++row)
+    {
+        block_size += editor->lines[row].size + ending_size;
+        if (block_size >= EDITOR_SAVE_BLOCK_SIZE || row + 1 == editor->size)
+        {
+            if (job->blocks_count + 2 > capacity)
+            {
+                capacity *= 2;
+                job->block_rows = (size_t *)realloc(job->block_rows, capacity * sizeof(job->block_rows[0]));
+                assert(job->block_rows != NULL);
+            }
+            job->blocks_count += 1;
+            job->block_rows[job->blocks_count] = row + 1;
+            total += block_size;
+            block_size = 0;
+        }
+    }
+
+    return total;
+}
+
 void editor_save_to_file(const Editor *editor, const char *file_path)
 {
-    FILE *f = fopen(file_path, "w");
+    FILE *f = fopen(file_path, "wb");
     if (f == NULL)
     {
         fprintf(stdout, "ERROR: could not open file %s : %s\n", file_path, strerror(errno));
         return;
     }
 
-    for (size_t row = 0; row < editor->size; row++)
+    Save_Job job = {0};
+    job.editor = editor;
+    const size_t total = save_job_split_blocks(&job);
+
+    size_t workers_count = 0;
+    SDL_Thread *workers[EDITOR_SAVE_MAX_WORKERS] = {0};
+    if (total >= EDITOR_SAVE_PARALLEL_THRESHOLD)
+    {
+        job.mutex = SDL_CreateMutex();
+        job.cond = SDL_CreateCond();
+        if (job.mutex != NULL && job.cond != NULL)
+        {
+            workers_count = (size_t)SDL_GetCPUCount();
+            if (workers_count > EDITOR_SAVE_MAX_WORKERS)
+            {
+                workers_count = EDITOR_SAVE_MAX_WORKERS;
+            }
+            if (workers_count > job.blocks_count)
+            {
+                workers_count = job.blocks_count;
+            }
+        }
+    }
+    job.slots_count = workers_count > 0 ? workers_count * EDITOR_SAVE_SLOTS_PER_WORKER : 1;
+
+    size_t spawned = 0;
+    for (; spawned < workers_count; ++spawned)
+    {
+        workers[spawned] = SDL_CreateThread(save_job_worker, "save_worker", &job);
+        if (workers[spawned] == NULL)
+        {
+            break;
+        }
+    }
+    workers_count = spawned;
+
+    bool ok = true;
+    for (size_t index = 0; index < job.blocks_count; ++index)
+    {
+        Save_Block *block = &job.slots[index % job.slots_count];
+
+        if (workers_count == 0)
+        {
+            save_block_serialize(block, editor, job.block_rows[index], job.block_rows[index + 1]);
+        }
+        else
+        {
+            SDL_LockMutex(job.mutex);
+            while (!block->ready)
+            {
+                SDL_CondWait(job.cond, job.mutex);
+            }
+            SDL_UnlockMutex(job.mutex);
+        }
+
+        ok = fwrite(block->data, 1, block->size, f) == block->size;
+
+        if (workers_count > 0)
+        {
+            SDL_LockMutex(job.mutex);
+            block->ready = false;
+            job.written_blocks += 1;
+            if (!ok)
+            {
+                job.next_block = job.blocks_count;
+            }
+            SDL_CondBroadcast(job.cond);
+            SDL_UnlockMutex(job.mutex);
+        }
+
+        if (!ok)
+        {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < workers_count; ++i)
+    {
+        SDL_WaitThread(workers[i], NULL);
+    }
+
+    if (!ok || ferror(f))
+    {
+        fprintf(stdout, "ERROR: could not write file %s : %s\n", file_path, strerror(errno));
+    }
+
+    for (size_t i = 0; i < job.slots_count; ++i)
+    {
+        free(job.slots[i].data);
+    }
+    free(job.block_rows);
+    if (job.cond)
+    {
+        SDL_DestroyCond(job.cond);
+    }
+    if (job.mutex)
     {
-        fwrite(editor->lines[row].chars, 1, editor->lines[row].size, f);
-        fputc('\n', f);
+        SDL_DestroyMutex(job.mutex);
     }
 
     fclose(f);
 }
 
+// Counts '\n' bytes and the ones preceded by '\r'. `prev` is the last byte
+// of the previous chunk so CRLF pairs split across chunks are not missed.
+static void line_ending_scan(const char *data, size_t size, char prev, size_t *lf_count, size_t *crlf_count)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128((const __m128i *)(data + i));
+        const unsigned int lf_mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, lf));
+        if (lf_mask == 0)
+        {
+            continue;
+        }
+        const unsigned int cr_mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, cr));
+        const unsigned int cr_before = (cr_mask << 1) | ((i > 0 ? data[i - 1] : prev) == '\r');
+        *lf_count += (size_t)__builtin_popcount(lf_mask);
+        *crlf_count += (size_t)__builtin_popcount(lf_mask & cr_before);
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        if (data[i] == '\n')
+        {
+            *lf_count += 1;
+            if ((i > 0 ? data[i - 1] : prev) == '\r')
+            {
+                *crlf_count += 1;
+            }
+        }
+    }
+}
+
 void editor_load_from_file(Editor *editor, FILE* file)
 {
     assert(editor->lines == NULL && "You can only load files into an emty editor");
@@ -229,9 +601,20 @@ void editor_load_from_file(Editor *editor, FILE* file)
 
     static char chunk[EDITOR_LOAD_CAPACITY];
 
+    size_t lf_count = 0;
+    size_t crlf_count = 0;
+    char prev = '\0';
+
     while (!feof(file))
     {
         size_t n = fread(chunk, 1, sizeof(chunk), file);
+        if (n == 0)
+        {
+            break;
+        }
+
+        line_ending_scan(chunk, n, prev, &lf_count, &crlf_count);
+        prev = chunk[n - 1];
 
         String_View chunk_sv = {
             .data = chunk,
@@ -248,12 +631,31 @@ void editor_load_from_file(Editor *editor, FILE* file)
             }
             else
             {
-                line_append_text_sized(line, chunk_line.data, chunk_line.count);
+                line_append_text_sized(line, chunk_sv.data, chunk_sv.count);
                 chunk_sv = SV_NULL;
             }
         }
     }
 
+    // Only a file where every line break is CRLF is treated as such. Mixed
+    // files keep their stray '\r' bytes inside the lines, which still saves
+    // back byte for byte.
+    if (lf_count > 0 && crlf_count == lf_count)
+    {
+        editor->line_ending = LINE_ENDING_CRLF;
+        for (size_t row = 0; row + 1 < editor->size; ++row)
+        {
+            Line *line = &editor->lines[row];
+            assert(line->size > 0 && line->chars[line->size - 1] == '\r');
+            line->size -= 1;
+            line_touch(line);
+        }
+    }
+    else
+    {
+        editor->line_ending = LINE_ENDING_LF;
+    }
+
     editor->cursor_row = 0;
     editor->cursor_col = 0;
-}
\ No newline at end of file
+}
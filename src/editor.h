@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #ifndef EDITOR_H_
 #define EDITOR_H_
@@ -9,6 +10,9 @@ typedef struct
     char *chars;
     size_t capacity;
     size_t size;
+    // Bumped to a buffer-wide unique value by every line_* mutator, so
+    // renderers can tell whether cached geometry for a line is still valid.
+    uint64_t version;
 } Line;
 
 void line_insert_text_before(Line *line, const char *text, size_t *col);
@@ -18,12 +22,18 @@ void line_delete(Line *line, size_t *col);
 void line_append_text(Line *line, const char* text);
 void line_append_text_sized(Line *line, const char* text, size_t text_size);
 
+typedef enum {
+    LINE_ENDING_LF = 0,
+    LINE_ENDING_CRLF,
+} Line_Ending;
+
 typedef struct {
     size_t capacity;
     size_t size;
     Line *lines;
     size_t cursor_row;
     size_t cursor_col;
+    Line_Ending line_ending;
 } Editor;
 
 void editor_save_to_file(const Editor *editor, const char* file_path);
@@ -34,4 +44,8 @@ void editor_backspace(Editor *editor);
 void editor_delete(Editor *editor);
 const char* editor_char_under_cursor(const Editor* editor);
 
+size_t utf8_decode(const char *text, size_t text_size, uint32_t *codepoint);
+size_t utf8_count(const char *text, size_t text_size);
+size_t utf8_advance(const char *text, size_t text_size, size_t codepoints);
+
 #endif
\ No newline at end of file
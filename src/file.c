@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <math.h>
 #include <string.h>
+#include <errno.h>
 #include "file.h"
 
 char *slurp_file_into_malloced_cstr(const char *file_path)
@@ -52,4 +53,52 @@ fail:
         free(buffer);
     }
     return NULL;
-}
\ No newline at end of file
+}
+
+char *slurp_file_into_malloced_buffer(const char *file_path, size_t *size)
+{
+    FILE *f = NULL;
+    char *buffer = NULL;
+    long n;
+
+    f = fopen(file_path, "rb");
+    if (f == NULL)
+        goto fail;
+    if (fseek(f, 0, SEEK_END) < 0)
+        goto fail;
+
+    n = ftell(f);
+    if (n < 0)
+        goto fail;
+
+    buffer = (char *)malloc(n > 0 ? n : 1);
+    if (buffer == NULL)
+        goto fail;
+
+    if (fseek(f, 0, SEEK_SET) < 0)
+        goto fail;
+
+    if (fread(buffer, 1, n, f) != (size_t)n)
+        goto fail;
+
+    *size = (size_t)n;
+
+    if (f)
+    {
+        fclose(f);
+        errno = 0;
+    }
+    return buffer;
+fail:
+    if (f)
+    {
+        int saved_errno = errno;
+        fclose(f);
+        errno = saved_errno;
+    }
+    if (buffer)
+    {
+        free(buffer);
+    }
+    return NULL;
+}
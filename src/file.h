@@ -1,6 +1,9 @@
 #ifndef FILE_H_
 #define FILE_H_
 
+#include <stddef.h>
+
 char *slurp_file_into_malloced_cstr(const char* file_path);
+char *slurp_file_into_malloced_buffer(const char* file_path, size_t *size);
 
 #endif
\ No newline at end of file
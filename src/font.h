@@ -0,0 +1,31 @@
+#ifndef FONT_H_
+#define FONT_H_
+
+#define FONT_WIDTH 128
+#define FONT_HEIGHT 64
+#define FONT_COLS 18
+#define FONT_ROWS 7
+#define FONT_CHAR_WIDTH (FONT_WIDTH / FONT_COLS)
+#define FONT_CHAR_HEIGHT (FONT_HEIGHT / FONT_ROWS)
+#define FONT_SCALE 2
+
+#define FONT_TTF_FILE_PATH "./font/VictorMono-Regular.ttf"
+#define FONT_TTF_PIXEL_SIZE 18
+
+#define ASCII_DISPLAY_LOW 32
+#define ASCII_DISPLAY_HIGH 126
+
+#define FONT_GLYPH_COUNT (ASCII_DISPLAY_HIGH - ASCII_DISPLAY_LOW + 1)
+
+typedef struct
+{
+    int x, y, w, h;
+} Font_Glyph_Rect;
+
+// Embedded copy of charmap-oldschool_white.png, see src/font_charmap.c.
+// Glyph rectangles start at ASCII_DISPLAY_LOW, pixels are one coverage byte
+// each, row-major.
+extern const Font_Glyph_Rect font_glyph_table[FONT_GLYPH_COUNT];
+extern const unsigned char font_charmap[FONT_WIDTH * FONT_HEIGHT];
+
+#endif
@@ -1,5 +0,0 @@
-#version 300
-
-void main(){
-    
-}
\ No newline at end of file
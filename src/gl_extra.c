@@ -6,10 +6,8 @@
 #include <string.h>
 #include <errno.h>
 #include <math.h>
+#include <stdint.h>
 
-#define GLFW_INCLUDE_GLEXT
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
 
 #include "file.h"
 #include "gl_extra.h"
@@ -47,25 +45,155 @@ bool compile_shader_source(const GLchar *source, GLenum shader_type, GLuint *sha
     return true;
 }
 
-bool compile_shader_file(const char *file_path, GLenum shader_type, GLuint *shader)
+static char *read_shader_file(const char *file_path)
 {
     char *source = slurp_file_into_malloced_cstr(file_path);
     if (source == NULL) {
         fprintf(stderr, "ERROR: failed to read file `%s`: %s\n", file_path, strerror(errno));
         errno = 0;
-        return false;
     }
-    bool ok = compile_shader_source(source, shader_type, shader);
+    return source;
+}
+
+static bool compile_shader_named(const char *source, const char *file_path, GLenum shader_type, GLuint *shader)
+{
+    const bool ok = compile_shader_source(source, shader_type, shader);
     if (!ok) {
         fprintf(stderr, "ERROR: failed to compile `%s` shader file\n", file_path);
     }
-    free(source);
     return ok;
 }
 
+// Directory (with trailing separator) where linked program binaries are
+// cached, empty when the cache is disabled.
+static char program_cache_dir[1024] = {0};
+
+void program_cache_set_dir(const char *dir)
+{
+    if (dir == NULL) {
+        program_cache_dir[0] = '\0';
+        return;
+    }
+    snprintf(program_cache_dir, sizeof(program_cache_dir), "%s", dir);
+}
+
+static bool program_cache_enabled(void)
+{
+    return program_cache_dir[0] != '\0' && GLEW_ARB_get_program_binary;
+}
+
+static uint64_t program_cache_hash(uint64_t hash, const char *data)
+{
+    for (; data != NULL && *data != '\0'; ++data) {
+        hash = (hash ^ (unsigned char)*data) * 1099511628211ULL;
+    }
+    // Separator, so moving text between two fields changes the hash.
+    return (hash ^ 0xff) * 1099511628211ULL;
+}
+
+// Binaries are only valid for the driver that produced them, so the key
+// covers the driver strings as well as both shader sources.
+static bool program_cache_path(const char *vert_source, const char *frag_source, char *path, size_t path_size)
+{
+    if (!program_cache_enabled()) {
+        return false;
+    }
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        return false;
+    }
+
+    uint64_t hash = 14695981039346656037ULL;
+    hash = program_cache_hash(hash, (const char *)glGetString(GL_VENDOR));
+    hash = program_cache_hash(hash, (const char *)glGetString(GL_RENDERER));
+    hash = program_cache_hash(hash, (const char *)glGetString(GL_VERSION));
+    hash = program_cache_hash(hash, vert_source);
+    hash = program_cache_hash(hash, frag_source);
+
+    snprintf(path, path_size, "%sprogram-%016llx.bin", program_cache_dir, (unsigned long long)hash);
+    return true;
+}
+
+// A missing, truncated or rejected binary is a cache miss, not an error.
+static bool program_cache_load(const char *path, GLuint *program)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+
+    bool ok = false;
+    void *binary = NULL;
+    GLenum format = 0;
+    long size = 0;
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) > (long)sizeof(format) && fseek(f, 0, SEEK_SET) == 0) {
+        const size_t binary_size = (size_t)size - sizeof(format);
+        binary = malloc(binary_size);
+        if (binary != NULL &&
+            fread(&format, sizeof(format), 1, f) == 1 &&
+            fread(binary, binary_size, 1, f) == 1) {
+            *program = glCreateProgram();
+            glProgramBinary(*program, format, binary, (GLsizei)binary_size);
+
+            GLint linked = 0;
+            glGetProgramiv(*program, GL_LINK_STATUS, &linked);
+            ok = linked;
+            if (!ok) {
+                glDeleteProgram(*program);
+                *program = 0;
+            }
+        }
+    }
+
+    free(binary);
+    fclose(f);
+    return ok;
+}
+
+static void program_cache_save(const char *path, GLuint program)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    void *binary = malloc((size_t)length);
+    if (binary == NULL) {
+        return;
+    }
+
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary);
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        fprintf(stderr, "WARNING: could not cache program binary %s: %s\n", path, strerror(errno));
+        errno = 0;
+        free(binary);
+        return;
+    }
+
+    if (fwrite(&format, sizeof(format), 1, f) != 1 ||
+        fwrite(binary, (size_t)length, 1, f) != 1) {
+        fprintf(stderr, "WARNING: could not cache program binary %s: %s\n", path, strerror(errno));
+        errno = 0;
+        fclose(f);
+        remove(path);
+    } else {
+        fclose(f);
+    }
+    free(binary);
+}
+
 bool link_program(GLuint vert_shader, GLuint frag_shader, GLuint *program)
 {
     *program = glCreateProgram();
+    if (program_cache_enabled()) {
+        glProgramParameteri(*program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
 
     glAttachShader(*program, vert_shader);
     glAttachShader(*program, frag_shader);
@@ -84,5 +212,58 @@ bool link_program(GLuint vert_shader, GLuint frag_shader, GLuint *program)
     glDeleteShader(vert_shader);
     glDeleteShader(frag_shader);
 
-    return program;
+    return linked;
+}
+
+// Uses the cached binary of the program when there is a valid one and
+// compiles from source (refreshing the cache) otherwise.
+bool link_program_files(const char *vert_file_path, const char *frag_file_path, GLuint *program)
+{
+    char *vert_source = read_shader_file(vert_file_path);
+    char *frag_source = read_shader_file(frag_file_path);
+    if (vert_source == NULL || frag_source == NULL) {
+        free(vert_source);
+        free(frag_source);
+        return false;
+    }
+
+    char cache_path[1024 + 64];
+    const bool cacheable = program_cache_path(vert_source, frag_source, cache_path, sizeof(cache_path));
+
+    bool ok = false;
+    if (cacheable && program_cache_load(cache_path, program)) {
+        ok = true;
+    } else {
+        GLuint vert_shader = 0;
+        GLuint frag_shader = 0;
+        if (compile_shader_named(vert_source, vert_file_path, GL_VERTEX_SHADER, &vert_shader)) {
+            if (compile_shader_named(frag_source, frag_file_path, GL_FRAGMENT_SHADER, &frag_shader)) {
+                ok = link_program(vert_shader, frag_shader, program);
+                if (ok && cacheable) {
+                    program_cache_save(cache_path, *program);
+                }
+            } else {
+                glDeleteShader(vert_shader);
+            }
+        }
+    }
+
+    free(vert_source);
+    free(frag_source);
+    return ok;
+}
+
+void load_coverage_texture(const unsigned char *pixels, int w, int h, GLuint *texture)
+{
+    glGenTextures(1, texture);
+    glBindTexture(GL_TEXTURE_2D, *texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
\ No newline at end of file
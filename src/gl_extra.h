@@ -1,12 +1,17 @@
-#define GLFW_INCLUDE_GLEXT
+#include <stdbool.h>
+#define GLEW_STATIC
 #include <GL/glew.h>
-#include <GLFW/glfw3.h>
 
 #ifndef GL_EXTRA_H_
 #define GL_EXTRA_H_
 
 bool compile_shader_source(const GLchar *source, GLenum shader_type, GLuint *shader);
-bool compile_shader_file(const char *file_path, GLenum shader_type, GLuint *shader);
 bool link_program(GLuint vert_shader, GLuint frag_shader, GLuint *program);
+bool link_program_files(const char *vert_file_path, const char *frag_file_path, GLuint *program);
+// Enables the on-disk cache of linked programs used by link_program_files.
+// `dir` must end with a path separator, NULL disables the cache.
+void program_cache_set_dir(const char *dir);
+// One byte of coverage per pixel, sampled through the red channel.
+void load_coverage_texture(const unsigned char *pixels, int w, int h, GLuint *texture);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,302 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "glyph_atlas.h"
+
+#define GLYPH_ATLAS_NONE ((size_t)-1)
+
+static size_t glyph_atlas_bucket(uint32_t codepoint, uint32_t pixel_size)
+{
+    const uint32_t hash = (codepoint * 2654435761u) ^ (pixel_size * 40503u);
+    return hash % GLYPH_ATLAS_BUCKETS;
+}
+
+bool glyph_atlas_init(Glyph_Atlas *atlas, const char *font_file_path)
+{
+    memset(atlas, 0, sizeof(*atlas));
+
+    FT_Error error = FT_Init_FreeType(&atlas->library);
+    if (error)
+    {
+        fprintf(stderr, "ERROR: could not initialize FreeType: %d\n", error);
+        return false;
+    }
+
+    error = FT_New_Face(atlas->library, font_file_path, 0, &atlas->face);
+    if (error)
+    {
+        fprintf(stderr, "ERROR: could not load font file %s: %d\n", font_file_path, error);
+        FT_Done_FreeType(atlas->library);
+        return false;
+    }
+
+    atlas->pixels = (uint8_t *)calloc(GLYPH_ATLAS_WIDTH * GLYPH_ATLAS_HEIGHT, 1);
+    assert(atlas->pixels != NULL);
+
+    for (size_t i = 0; i < GLYPH_ATLAS_BUCKETS; ++i)
+    {
+        atlas->buckets[i] = GLYPH_ATLAS_NONE;
+    }
+    for (size_t i = 0; i < GLYPH_ATLAS_MAX_GLYPHS; ++i)
+    {
+        atlas->glyphs[i].next = i + 1 < GLYPH_ATLAS_MAX_GLYPHS ? i + 1 : GLYPH_ATLAS_NONE;
+    }
+    atlas->free_glyph = 0;
+
+    return true;
+}
+
+void glyph_atlas_begin_frame(Glyph_Atlas *atlas)
+{
+    atlas->frame += 1;
+}
+
+static void glyph_atlas_set_size(Glyph_Atlas *atlas, uint32_t pixel_size)
+{
+    if (atlas->face_pixel_size != pixel_size)
+    {
+        FT_Set_Pixel_Sizes(atlas->face, 0, pixel_size);
+        atlas->face_pixel_size = pixel_size;
+    }
+}
+
+void glyph_atlas_cell_size(Glyph_Atlas *atlas, uint32_t pixel_size, int *width, int *height, int *ascender)
+{
+    glyph_atlas_set_size(atlas, pixel_size);
+
+    const FT_Size_Metrics *metrics = &atlas->face->size->metrics;
+    *height = (int)(metrics->height >> 6);
+    *ascender = (int)(metrics->ascender >> 6);
+
+    // The bundled font is monospaced, any glyph's advance is the cell width.
+    *width = (int)(metrics->max_advance >> 6);
+    if (FT_Load_Char(atlas->face, 'M', FT_LOAD_DEFAULT) == 0)
+    {
+        *width = (int)(atlas->face->glyph->advance.x >> 6);
+    }
+}
+
+static void glyph_atlas_mark_dirty(Glyph_Atlas *atlas, Glyph_Atlas_Rect rect)
+{
+    if (atlas->dirty_count < GLYPH_ATLAS_MAX_DIRTY)
+    {
+        atlas->dirty[atlas->dirty_count++] = rect;
+        return;
+    }
+
+    // Out of slots, fold everything into the last rectangle.
+    Glyph_Atlas_Rect *last = &atlas->dirty[GLYPH_ATLAS_MAX_DIRTY - 1];
+    const int x0 = rect.x < last->x ? rect.x : last->x;
+    const int y0 = rect.y < last->y ? rect.y : last->y;
+    const int x1 = rect.x + rect.w > last->x + last->w ? rect.x + rect.w : last->x + last->w;
+    const int y1 = rect.y + rect.h > last->y + last->h ? rect.y + rect.h : last->y + last->h;
+    *last = (Glyph_Atlas_Rect){x0, y0, x1 - x0, y1 - y0};
+}
+
+void glyph_atlas_clear_dirty(Glyph_Atlas *atlas)
+{
+    atlas->dirty_count = 0;
+}
+
+static void glyph_atlas_unlink(Glyph_Atlas *atlas, size_t index)
+{
+    Glyph_Atlas_Entry *entry = &atlas->glyphs[index];
+    size_t *link = &atlas->buckets[glyph_atlas_bucket(entry->codepoint, entry->pixel_size)];
+    while (*link != index)
+    {
+        assert(*link != GLYPH_ATLAS_NONE);
+        link = &atlas->glyphs[*link].next;
+    }
+    *link = entry->next;
+
+    entry->in_use = false;
+    entry->next = atlas->free_glyph;
+    atlas->free_glyph = index;
+}
+
+static void glyph_atlas_evict_shelf(Glyph_Atlas *atlas, size_t shelf)
+{
+    for (size_t i = 0; i < GLYPH_ATLAS_MAX_GLYPHS; ++i)
+    {
+        if (atlas->glyphs[i].in_use && atlas->glyphs[i].shelf == shelf)
+        {
+            glyph_atlas_unlink(atlas, i);
+        }
+    }
+    atlas->shelves[shelf].x = 0;
+}
+
+// Least recently used shelf that is tall enough and was not used this frame.
+static size_t glyph_atlas_lru_shelf(Glyph_Atlas *atlas, int h)
+{
+    size_t lru = GLYPH_ATLAS_NONE;
+    for (size_t i = 0; i < atlas->shelves_count; ++i)
+    {
+        const Glyph_Atlas_Shelf *shelf = &atlas->shelves[i];
+        if (shelf->height >= h && shelf->last_used < atlas->frame &&
+            (lru == GLYPH_ATLAS_NONE || shelf->last_used < atlas->shelves[lru].last_used))
+        {
+            lru = i;
+        }
+    }
+    return lru;
+}
+
+static bool glyph_atlas_alloc(Glyph_Atlas *atlas, int w, int h, size_t *shelf_index, Glyph_Atlas_Rect *rect)
+{
+    w += GLYPH_ATLAS_PADDING;
+    h += GLYPH_ATLAS_PADDING;
+    if (w > GLYPH_ATLAS_WIDTH || h > GLYPH_ATLAS_HEIGHT)
+    {
+        return false;
+    }
+
+    size_t found = GLYPH_ATLAS_NONE;
+    for (size_t i = 0; i < atlas->shelves_count; ++i)
+    {
+        const Glyph_Atlas_Shelf *shelf = &atlas->shelves[i];
+        if (shelf->height >= h && shelf->height <= h + h / 4 + 2 &&
+            shelf->x + w <= GLYPH_ATLAS_WIDTH)
+        {
+            found = i;
+            break;
+        }
+    }
+
+    if (found == GLYPH_ATLAS_NONE &&
+        atlas->shelves_count < GLYPH_ATLAS_MAX_SHELVES &&
+        atlas->shelves_bottom + h <= GLYPH_ATLAS_HEIGHT)
+    {
+        found = atlas->shelves_count++;
+        atlas->shelves[found] = (Glyph_Atlas_Shelf){
+            .y = atlas->shelves_bottom,
+            .height = h,
+            .x = 0,
+            .last_used = 0,
+        };
+        atlas->shelves_bottom += h;
+    }
+
+    if (found == GLYPH_ATLAS_NONE)
+    {
+        found = glyph_atlas_lru_shelf(atlas, h);
+        if (found == GLYPH_ATLAS_NONE)
+        {
+            return false;
+        }
+        glyph_atlas_evict_shelf(atlas, found);
+    }
+
+    Glyph_Atlas_Shelf *shelf = &atlas->shelves[found];
+    *shelf_index = found;
+    *rect = (Glyph_Atlas_Rect){
+        .x = shelf->x,
+        .y = shelf->y,
+        .w = w - GLYPH_ATLAS_PADDING,
+        .h = h - GLYPH_ATLAS_PADDING,
+    };
+    shelf->x += w;
+    return true;
+}
+
+static const Glyph_Atlas_Entry *glyph_atlas_rasterize(Glyph_Atlas *atlas, uint32_t codepoint, uint32_t pixel_size)
+{
+    glyph_atlas_set_size(atlas, pixel_size);
+
+    FT_UInt glyph_index = FT_Get_Char_Index(atlas->face, codepoint);
+    if (glyph_index == 0)
+    {
+        return NULL;
+    }
+    if (FT_Load_Glyph(atlas->face, glyph_index, FT_LOAD_RENDER))
+    {
+        return NULL;
+    }
+
+    const FT_GlyphSlot slot = atlas->face->glyph;
+    const FT_Bitmap *bitmap = &slot->bitmap;
+
+    if (atlas->free_glyph == GLYPH_ATLAS_NONE)
+    {
+        const size_t shelf = glyph_atlas_lru_shelf(atlas, 0);
+        if (shelf == GLYPH_ATLAS_NONE)
+        {
+            return NULL;
+        }
+        glyph_atlas_evict_shelf(atlas, shelf);
+        if (atlas->free_glyph == GLYPH_ATLAS_NONE)
+        {
+            return NULL;
+        }
+    }
+
+    size_t shelf = 0;
+    Glyph_Atlas_Rect rect = {0};
+    if (!glyph_atlas_alloc(atlas, (int)bitmap->width, (int)bitmap->rows, &shelf, &rect))
+    {
+        return NULL;
+    }
+
+    for (int y = 0; y < rect.h; ++y)
+    {
+        memcpy(&atlas->pixels[(size_t)(rect.y + y) * GLYPH_ATLAS_WIDTH + (size_t)rect.x],
+               &bitmap->buffer[(size_t)y * (size_t)bitmap->pitch],
+               (size_t)rect.w);
+    }
+    if (rect.w > 0 && rect.h > 0)
+    {
+        glyph_atlas_mark_dirty(atlas, rect);
+    }
+
+    const size_t index = atlas->free_glyph;
+    Glyph_Atlas_Entry *entry = &atlas->glyphs[index];
+    atlas->free_glyph = entry->next;
+
+    const size_t bucket = glyph_atlas_bucket(codepoint, pixel_size);
+    *entry = (Glyph_Atlas_Entry){
+        .codepoint = codepoint,
+        .pixel_size = pixel_size,
+        .rect = rect,
+        .bearing_x = slot->bitmap_left,
+        .bearing_y = slot->bitmap_top,
+        .advance = (int)(slot->advance.x >> 6),
+        .shelf = shelf,
+        .next = atlas->buckets[bucket],
+        .in_use = true,
+    };
+    atlas->buckets[bucket] = index;
+
+    return entry;
+}
+
+const Glyph_Atlas_Entry *glyph_atlas_get(Glyph_Atlas *atlas, uint32_t codepoint, uint32_t pixel_size)
+{
+    const Glyph_Atlas_Entry *entry = NULL;
+
+    for (size_t i = atlas->buckets[glyph_atlas_bucket(codepoint, pixel_size)];
+         i != GLYPH_ATLAS_NONE;
+         i = atlas->glyphs[i].next)
+    {
+        if (atlas->glyphs[i].codepoint == codepoint && atlas->glyphs[i].pixel_size == pixel_size)
+        {
+            entry = &atlas->glyphs[i];
+            break;
+        }
+    }
+
+    if (entry == NULL)
+    {
+        entry = glyph_atlas_rasterize(atlas, codepoint, pixel_size);
+    }
+    if (entry == NULL && codepoint != '?')
+    {
+        return glyph_atlas_get(atlas, '?', pixel_size);
+    }
+
+    if (entry != NULL)
+    {
+        atlas->shelves[entry->shelf].last_used = atlas->frame;
+    }
+    return entry;
+}
@@ -0,0 +1,79 @@
+#ifndef GLYPH_ATLAS_H_
+#define GLYPH_ATLAS_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#define GLYPH_ATLAS_WIDTH 1024
+#define GLYPH_ATLAS_HEIGHT 1024
+#define GLYPH_ATLAS_MAX_GLYPHS 4096
+#define GLYPH_ATLAS_BUCKETS 1024
+#define GLYPH_ATLAS_MAX_SHELVES 256
+#define GLYPH_ATLAS_MAX_DIRTY 64
+#define GLYPH_ATLAS_PADDING 1
+
+typedef struct
+{
+    int x, y, w, h;
+} Glyph_Atlas_Rect;
+
+typedef struct
+{
+    uint32_t codepoint;
+    uint32_t pixel_size;
+    Glyph_Atlas_Rect rect;
+    int bearing_x;
+    int bearing_y;
+    int advance;
+
+    size_t shelf;
+    size_t next;
+    bool in_use;
+} Glyph_Atlas_Entry;
+
+typedef struct
+{
+    int y;
+    int height;
+    int x;
+    uint64_t last_used;
+} Glyph_Atlas_Shelf;
+
+// TrueType glyphs rasterized on demand into a shelf-packed coverage atlas.
+// Glyphs are cached by (codepoint, pixel size). When the atlas fills up the
+// least recently used shelf that was not touched in the current frame is
+// evicted and reused. Rasterized glyphs are recorded as dirty rectangles so
+// the renderer can upload just those with sub-image updates.
+typedef struct
+{
+    FT_Library library;
+    FT_Face face;
+    uint32_t face_pixel_size;
+
+    uint8_t *pixels;
+
+    Glyph_Atlas_Entry glyphs[GLYPH_ATLAS_MAX_GLYPHS];
+    size_t buckets[GLYPH_ATLAS_BUCKETS];
+    size_t free_glyph;
+
+    Glyph_Atlas_Shelf shelves[GLYPH_ATLAS_MAX_SHELVES];
+    size_t shelves_count;
+    int shelves_bottom;
+
+    uint64_t frame;
+
+    Glyph_Atlas_Rect dirty[GLYPH_ATLAS_MAX_DIRTY];
+    size_t dirty_count;
+} Glyph_Atlas;
+
+bool glyph_atlas_init(Glyph_Atlas *atlas, const char *font_file_path);
+void glyph_atlas_begin_frame(Glyph_Atlas *atlas);
+const Glyph_Atlas_Entry *glyph_atlas_get(Glyph_Atlas *atlas, uint32_t codepoint, uint32_t pixel_size);
+void glyph_atlas_cell_size(Glyph_Atlas *atlas, uint32_t pixel_size, int *width, int *height, int *ascender);
+void glyph_atlas_clear_dirty(Glyph_Atlas *atlas);
+
+#endif
@@ -0,0 +1,123 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "golden.h"
+#include "file.h"
+
+void golden_image_alloc(Golden_Image *image, int width, int height)
+{
+    image->width = width;
+    image->height = height;
+    image->rgb = (uint8_t *)malloc((size_t)width * (size_t)height * 3);
+    assert(image->rgb != NULL);
+}
+
+void golden_image_free(Golden_Image *image)
+{
+    free(image->rgb);
+    *image = (Golden_Image){0};
+}
+
+void golden_image_from_rgba(Golden_Image *image, const uint8_t *rgba, int width, int height, int pitch, bool flip)
+{
+    golden_image_alloc(image, width, height);
+    for (int y = 0; y < height; ++y)
+    {
+        const uint8_t *src = rgba + (size_t)(flip ? height - 1 - y : y) * (size_t)pitch;
+        uint8_t *dst = &image->rgb[(size_t)y * (size_t)width * 3];
+        for (int x = 0; x < width; ++x)
+        {
+            dst[x * 3 + 0] = src[x * 4 + 0];
+            dst[x * 3 + 1] = src[x * 4 + 1];
+            dst[x * 3 + 2] = src[x * 4 + 2];
+        }
+    }
+}
+
+void golden_image_from_xrgb(Golden_Image *image, const uint32_t *xrgb, int width, int height, int pitch)
+{
+    golden_image_alloc(image, width, height);
+    for (int y = 0; y < height; ++y)
+    {
+        const uint32_t *src = (const uint32_t *)((const uint8_t *)xrgb + (size_t)y * (size_t)pitch);
+        uint8_t *dst = &image->rgb[(size_t)y * (size_t)width * 3];
+        for (int x = 0; x < width; ++x)
+        {
+            dst[x * 3 + 0] = (uint8_t)(src[x] >> 16);
+            dst[x * 3 + 1] = (uint8_t)(src[x] >> 8);
+            dst[x * 3 + 2] = (uint8_t)src[x];
+        }
+    }
+}
+
+// Reads a "P6 <width> <height> 255" header followed by one whitespace byte,
+// which is all golden_image_write produces.
+bool golden_image_read(Golden_Image *image, const char *file_path)
+{
+    size_t size = 0;
+    char *data = slurp_file_into_malloced_buffer(file_path, &size);
+    if (data == NULL)
+    {
+        return false;
+    }
+
+    char head[64] = {0};
+    memcpy(head, data, size < sizeof(head) - 1 ? size : sizeof(head) - 1);
+
+    int width = 0, height = 0, maxval = 0, header = 0;
+    if (sscanf(head, "P6 %d %d %d%n", &width, &height, &maxval, &header) != 3 ||
+        maxval != 255 || width <= 0 || height <= 0 ||
+        (size_t)header + 1 + (size_t)width * (size_t)height * 3 != size)
+    {
+        fprintf(stderr, "ERROR: %s is not a golden image\n", file_path);
+        free(data);
+        return false;
+    }
+
+    golden_image_alloc(image, width, height);
+    memcpy(image->rgb, data + header + 1, (size_t)width * (size_t)height * 3);
+    free(data);
+    return true;
+}
+
+bool golden_image_write(const Golden_Image *image, const char *file_path)
+{
+    FILE *f = fopen(file_path, "wb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: could not open file %s : %s\n", file_path, strerror(errno));
+        return false;
+    }
+
+    fprintf(f, "P6\n%d %d\n255\n", image->width, image->height);
+    fwrite(image->rgb, 1, (size_t)image->width * (size_t)image->height * 3, f);
+
+    const bool ok = !ferror(f);
+    if (!ok)
+    {
+        fprintf(stderr, "ERROR: could not write file %s : %s\n", file_path, strerror(errno));
+    }
+    fclose(f);
+    return ok;
+}
+
+size_t golden_image_diff(const Golden_Image *a, const Golden_Image *b)
+{
+    if (a->width != b->width || a->height != b->height)
+    {
+        return SIZE_MAX;
+    }
+
+    size_t count = 0;
+    const size_t pixels = (size_t)a->width * (size_t)a->height;
+    for (size_t i = 0; i < pixels; ++i)
+    {
+        if (memcmp(&a->rgb[i * 3], &b->rgb[i * 3], 3) != 0)
+        {
+            count += 1;
+        }
+    }
+    return count;
+}
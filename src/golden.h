@@ -0,0 +1,32 @@
+#ifndef GOLDEN_H_
+#define GOLDEN_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Tightly packed 8 bit RGB, top row first. Stored on disk as binary PPM
+// (P6) so mismatches can be opened in any image viewer.
+typedef struct
+{
+    int width;
+    int height;
+    uint8_t *rgb;
+} Golden_Image;
+
+void golden_image_alloc(Golden_Image *image, int width, int height);
+void golden_image_free(Golden_Image *image);
+
+bool golden_image_read(Golden_Image *image, const char *file_path);
+bool golden_image_write(const Golden_Image *image, const char *file_path);
+
+// From 4 bytes per pixel RGBA (e.g. glReadPixels, bottom row first when
+// `flip`) or 0xXXRRGGBB words (an SDL XRGB/ARGB surface). `pitch` is in
+// bytes.
+void golden_image_from_rgba(Golden_Image *image, const uint8_t *rgba, int width, int height, int pitch, bool flip);
+void golden_image_from_xrgb(Golden_Image *image, const uint32_t *xrgb, int width, int height, int pitch);
+
+// Number of pixels that differ, SIZE_MAX when the sizes differ.
+size_t golden_image_diff(const Golden_Image *a, const Golden_Image *b);
+
+#endif
@@ -0,0 +1,139 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "font.h"
+#include "grid_glyph.h"
+#include "profiler.h"
+
+bool grid_glyph_init(Grid_Glyph_Renderer *grid, const char *vert_file_path, const char *frag_file_path)
+{
+    glActiveTexture(GL_TEXTURE0);
+    load_coverage_texture(font_charmap, FONT_WIDTH, FONT_HEIGHT, &grid->font_texture);
+
+    if (!link_program_files(vert_file_path, frag_file_path, &grid->program))
+    {
+        return false;
+    }
+
+    glUseProgram(grid->program);
+    glUniform1i(glGetUniformLocation(grid->program, "font"), 0);
+    glUniform1i(glGetUniformLocation(grid->program, "grid"), 1);
+    glUniform1i(glGetUniformLocation(grid->program, "atlas_cols"), FONT_COLS);
+    glUniform2f(glGetUniformLocation(grid->program, "atlas_cell_uv"),
+                (float)FONT_CHAR_WIDTH / FONT_WIDTH,
+                (float)FONT_CHAR_HEIGHT / FONT_HEIGHT);
+    grid->resolution_uniform = glGetUniformLocation(grid->program, "resolution");
+    grid->origin_uniform = glGetUniformLocation(grid->program, "origin");
+    grid->glyph_size_uniform = glGetUniformLocation(grid->program, "glyph_size");
+    grid->grid_size_uniform = glGetUniformLocation(grid->program, "grid_size");
+
+    glActiveTexture(GL_TEXTURE1);
+    glGenTextures(1, &grid->grid_texture);
+    glBindTexture(GL_TEXTURE_2D, grid->grid_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glActiveTexture(GL_TEXTURE0);
+
+    // The fullscreen quad is generated from gl_VertexID, the core profile
+    // still wants a vertex array bound for the draw.
+    glGenVertexArrays(1, &grid->vao);
+
+    return true;
+}
+
+void grid_glyph_reset(Grid_Glyph_Renderer *grid, size_t cols, size_t rows)
+{
+    const size_t count = cols * rows;
+    if (count > grid->cells_capacity)
+    {
+        grid->cells = (uint32_t *)realloc(grid->cells, count * sizeof(grid->cells[0]));
+        profiler_count(PROFILER_COUNTER_ALLOCATIONS, 1);
+        assert(grid->cells != NULL);
+        grid->cells_capacity = count;
+    }
+
+    grid->cols = cols;
+    grid->rows = rows;
+    memset(grid->cells, 0, count * sizeof(grid->cells[0]));
+}
+
+void grid_glyph_set_text_sized(Grid_Glyph_Renderer *grid, size_t col, size_t row, const char *text, size_t text_size)
+{
+    if (row >= grid->rows || col >= grid->cols)
+    {
+        return;
+    }
+    if (text_size > grid->cols - col)
+    {
+        text_size = grid->cols - col;
+    }
+
+    uint32_t *cells = &grid->cells[row * grid->cols + col];
+    for (size_t i = 0; i < text_size; ++i)
+    {
+        cells[i] = (unsigned char)text[i];
+    }
+}
+
+void grid_glyph_set_attrs(Grid_Glyph_Renderer *grid, size_t col, size_t row, uint32_t attrs)
+{
+    if (row < grid->rows && col < grid->cols)
+    {
+        uint32_t *cell = &grid->cells[row * grid->cols + col];
+        if ((*cell & 0xffff) == 0)
+        {
+            *cell = ' ';
+        }
+        *cell |= attrs << 16;
+    }
+}
+
+void grid_glyph_sync(Grid_Glyph_Renderer *grid)
+{
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, grid->grid_texture);
+
+    if (grid->cols > grid->texture_cols || grid->rows > grid->texture_rows)
+    {
+        if (grid->cols > grid->texture_cols)
+        {
+            grid->texture_cols = grid->cols;
+        }
+        if (grid->rows > grid->texture_rows)
+        {
+            grid->texture_rows = grid->rows;
+        }
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, (GLsizei)grid->texture_cols, (GLsizei)grid->texture_rows, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+    }
+
+    if (grid->cols > 0 && grid->rows > 0)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei)grid->cols, (GLsizei)grid->rows, GL_RED_INTEGER, GL_UNSIGNED_INT, grid->cells);
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void grid_glyph_draw(Grid_Glyph_Renderer *grid, Vec2f resolution, Vec2f origin, float scale)
+{
+    glUseProgram(grid->program);
+    glUniform2f(grid->resolution_uniform, resolution.x, resolution.y);
+    glUniform2f(grid->origin_uniform, origin.x, origin.y);
+    glUniform2f(grid->glyph_size_uniform, FONT_CHAR_WIDTH * scale, FONT_CHAR_HEIGHT * scale);
+    glUniform2i(grid->grid_size_uniform, (GLint)grid->cols, (GLint)grid->rows);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, grid->font_texture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, grid->grid_texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(grid->vao);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    profiler_count(PROFILER_COUNTER_DRAW_CALLS, 1);
+    profiler_count(PROFILER_COUNTER_GLYPHS, grid->cols * grid->rows);
+}
@@ -0,0 +1,42 @@
+#ifndef GRID_GLYPH_H_
+#define GRID_GLYPH_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gl_extra.h"
+#include "la.h"
+
+// Each grid cell is a 32 bit texel: the character code in the low 16 bits
+// and GRID_GLYPH_ATTR_* flags in the high 16 bits. Code 0 is an empty cell.
+#define GRID_GLYPH_ATTR_INVERSE (1u << 0)
+
+typedef struct
+{
+    GLuint vao;
+    GLuint program;
+    GLuint font_texture;
+    GLuint grid_texture;
+
+    GLint resolution_uniform;
+    GLint origin_uniform;
+    GLint glyph_size_uniform;
+    GLint grid_size_uniform;
+
+    size_t cols;
+    size_t rows;
+    size_t texture_cols;
+    size_t texture_rows;
+    size_t cells_capacity;
+    uint32_t *cells;
+} Grid_Glyph_Renderer;
+
+bool grid_glyph_init(Grid_Glyph_Renderer *grid, const char *vert_file_path, const char *frag_file_path);
+void grid_glyph_reset(Grid_Glyph_Renderer *grid, size_t cols, size_t rows);
+void grid_glyph_set_text_sized(Grid_Glyph_Renderer *grid, size_t col, size_t row, const char *text, size_t text_size);
+void grid_glyph_set_attrs(Grid_Glyph_Renderer *grid, size_t col, size_t row, uint32_t attrs);
+void grid_glyph_sync(Grid_Glyph_Renderer *grid);
+void grid_glyph_draw(Grid_Glyph_Renderer *grid, Vec2f resolution, Vec2f origin, float scale);
+
+#endif
@@ -0,0 +1,131 @@
+#include "job_pool.h"
+
+// Called with the mutex held, returns with it held.
+static void job_pool_work(Job_Pool *pool)
+{
+    while (pool->next_job < pool->jobs_count)
+    {
+        const size_t job = pool->next_job++;
+        const Job_Pool_Func func = pool->func;
+        void *data = pool->data;
+        SDL_UnlockMutex(pool->mutex);
+
+        func(data, job);
+
+        SDL_LockMutex(pool->mutex);
+        pool->pending_jobs -= 1;
+        if (pool->pending_jobs == 0)
+        {
+            SDL_CondBroadcast(pool->done);
+        }
+    }
+}
+
+static int job_pool_worker(void *data)
+{
+    Job_Pool *pool = (Job_Pool *)data;
+
+    SDL_LockMutex(pool->mutex);
+    while (!pool->quit)
+    {
+        if (pool->next_job < pool->jobs_count)
+        {
+            job_pool_work(pool);
+        }
+        else
+        {
+            SDL_CondWait(pool->start, pool->mutex);
+        }
+    }
+    SDL_UnlockMutex(pool->mutex);
+
+    return 0;
+}
+
+void job_pool_init(Job_Pool *pool, size_t workers_count)
+{
+    *pool = (Job_Pool){0};
+    if (workers_count > JOB_POOL_MAX_WORKERS)
+    {
+        workers_count = JOB_POOL_MAX_WORKERS;
+    }
+    if (workers_count == 0)
+    {
+        return;
+    }
+
+    pool->mutex = SDL_CreateMutex();
+    pool->start = SDL_CreateCond();
+    pool->done = SDL_CreateCond();
+    if (pool->mutex == NULL || pool->start == NULL || pool->done == NULL)
+    {
+        return;
+    }
+
+    for (; pool->workers_count < workers_count; ++pool->workers_count)
+    {
+        pool->workers[pool->workers_count] = SDL_CreateThread(job_pool_worker, "job_worker", pool);
+        if (pool->workers[pool->workers_count] == NULL)
+        {
+            break;
+        }
+    }
+}
+
+void job_pool_run(Job_Pool *pool, Job_Pool_Func func, void *data, size_t jobs_count)
+{
+    // Waking the workers is not worth it for a single job.
+    if (pool->workers_count == 0 || jobs_count <= 1)
+    {
+        for (size_t job = 0; job < jobs_count; ++job)
+        {
+            func(data, job);
+        }
+        return;
+    }
+
+    SDL_LockMutex(pool->mutex);
+    pool->func = func;
+    pool->data = data;
+    pool->jobs_count = jobs_count;
+    pool->next_job = 0;
+    pool->pending_jobs = jobs_count;
+    SDL_CondBroadcast(pool->start);
+
+    job_pool_work(pool);
+    while (pool->pending_jobs > 0)
+    {
+        SDL_CondWait(pool->done, pool->mutex);
+    }
+    SDL_UnlockMutex(pool->mutex);
+}
+
+void job_pool_free(Job_Pool *pool)
+{
+    if (pool->workers_count > 0)
+    {
+        SDL_LockMutex(pool->mutex);
+        pool->quit = true;
+        SDL_CondBroadcast(pool->start);
+        SDL_UnlockMutex(pool->mutex);
+
+        for (size_t i = 0; i < pool->workers_count; ++i)
+        {
+            SDL_WaitThread(pool->workers[i], NULL);
+        }
+    }
+
+    if (pool->done)
+    {
+        SDL_DestroyCond(pool->done);
+    }
+    if (pool->start)
+    {
+        SDL_DestroyCond(pool->start);
+    }
+    if (pool->mutex)
+    {
+        SDL_DestroyMutex(pool->mutex);
+    }
+    *pool = (Job_Pool){0};
+}
@@ -0,0 +1,39 @@
+#ifndef JOB_POOL_H_
+#define JOB_POOL_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <SDL2/SDL.h>
+
+#define JOB_POOL_MAX_WORKERS 16
+
+// Runs `func(data, job)` for job in [0, jobs_count). Jobs must not depend on
+// each other, they run in any order and on any thread.
+typedef void (*Job_Pool_Func)(void *data, size_t job);
+
+// Persistent worker threads for work that is split and joined every frame,
+// where spawning threads per call would cost more than the work itself.
+// The calling thread takes jobs too, so a pool without workers (no threads
+// could be created) still runs everything, just serially.
+typedef struct
+{
+    size_t workers_count;
+    SDL_Thread *workers[JOB_POOL_MAX_WORKERS];
+    SDL_mutex *mutex;
+    SDL_cond *start;
+    SDL_cond *done;
+
+    Job_Pool_Func func;
+    void *data;
+    size_t jobs_count;
+    size_t next_job;
+    size_t pending_jobs;
+    bool quit;
+} Job_Pool;
+
+void job_pool_init(Job_Pool *pool, size_t workers_count);
+void job_pool_run(Job_Pool *pool, Job_Pool_Func func, void *data, size_t jobs_count);
+void job_pool_free(Job_Pool *pool);
+
+#endif
@@ -28,4 +28,17 @@ Vec2f vec2f_sub(Vec2f a, Vec2f b)
 Vec2f vec2f_div(Vec2f a, Vec2f b)
 {
     return vec2f(a.x / b.x, a.y / b.y);
+}
+
+Vec2i vec2i(int x, int y)
+{
+    return (Vec2i) {
+        .x = x,
+        .y = y
+    };
+}
+
+Vec2i vec2is(int x)
+{
+    return vec2i(x, x);
 }
\ No newline at end of file
@@ -12,4 +12,11 @@ Vec2f vec2f_mul(Vec2f a, Vec2f b);
 Vec2f vec2f_sub(Vec2f a, Vec2f b);
 Vec2f vec2f_div(Vec2f a, Vec2f b);
 
+typedef struct {
+    int x, y;
+} Vec2i;
+
+Vec2i vec2i(int x, int y);
+Vec2i vec2is(int x);
+
 #endif
\ No newline at end of file
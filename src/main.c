@@ -3,29 +3,33 @@
 #include <stdbool.h>
 #include <math.h>
 #include <string.h>
+#include <errno.h>
 #define GLEW_STATIC
 #include <GL/glew.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengl.h>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-
 #include "la.h"
 #include "editor.h"
-
-#define FONT_WIDTH 128
-#define FONT_HEIGHT 64
-#define FONT_COLS 18
-#define FONT_ROWS 7
-#define FONT_CHAR_WIDTH (FONT_WIDTH / FONT_COLS)
-#define FONT_CHAR_HEIGHT (FONT_HEIGHT / FONT_ROWS)
-#define FONT_SCALE 2
+#include "font.h"
+#include "tile_glyph.h"
+#include "grid_glyph.h"
+#include "glyph_atlas.h"
+#include "profiler.h"
+#include "job_pool.h"
+#include "soft_render.h"
+#include "golden.h"
+#include "tty.h"
 
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 600
+// Frame rate cap when presenting is not synchronized to the display.
 #define FPS 120
-#define DELTA_TIME (1.0f / FPS)
+#define SIMULATION_STEP (1.0f / 120)
+// Longest stretch of real time simulated at once, e.g. after the process
+// was suspended.
+#define SIMULATION_MAX_ELAPSED 0.25f
+#define IDLE_TIMEOUT_MS 1000
 
 void scc(int code)
 {
@@ -46,112 +50,407 @@ void *scp(void *ptr)
     return ptr;
 }
 
-SDL_Surface *surface_from_file(const char *file_path)
+typedef struct
 {
-    int w, h, n;
-    unsigned char *pixels = stbi_load(file_path, &w, &h, &n, STBI_rgb_alpha);
-    if (pixels == NULL)
-    {
-        fprintf(stderr, "Failed to load image: %s\n", stbi_failure_reason());
-        exit(1);
-    }
+    SDL_Texture *spritesheet;
+    Vec2f spritesheet_size;
+    const Font_Glyph_Rect *glyph_table;
+
+    // Set when glyphs come from the TrueType atlas instead of the bitmap
+    // spritesheet. Lines are then laid out per UTF-8 codepoint, not per byte.
+    Glyph_Atlas *atlas;
+    uint32_t pixel_size;
+    int ascender;
+} Font;
 
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-    int shift = (req_format == STBI_rgb) ? 8 : 0;
-    const Uint32 rmask = 0xff000000 >> shift;
-    const Uint32 gmask = 0x00ff0000 >> shift;
-    const Uint32 bmask = 0x0000ff00 >> shift;
-    const Uint32 amask = 0x000000ff >> shift;
-#else
-    const Uint32 rmask = 0x000000ff;
-    const Uint32 gmask = 0x0000ff00;
-    const Uint32 bmask = 0x00ff0000;
-    const Uint32 amask = 0xff000000;
-#endif
-    int depth = 32;
-    int pitch = w * 4;
+Font font = {0};
+Glyph_Atlas glyph_atlas = {0};
+Sdf_Atlas sdf_atlas = {0};
+Vec2f cell_size = {FONT_CHAR_WIDTH * FONT_SCALE, FONT_CHAR_HEIGHT * FONT_SCALE};
 
-    return (SDL_Surface *)scp(SDL_CreateRGBSurfaceFrom(pixels, w, h, depth, pitch, rmask, gmask, bmask, amask));
+void set_texture_color(SDL_Texture *texture, Uint32 color)
+{
+    scc(SDL_SetTextureColorMod(texture, (color >> (8 * 0) & 0xff), (color >> (8 * 1) & 0xff), (color >> (8 * 2) & 0xff)));
+    SDL_SetTextureAlphaMod(texture, (color >> (8 * 3) & 0xff));
 }
 
-#define ASCII_DISPLAY_LOW 32
-#define ASCII_DISPLAY_HIGH 126
+// Font loading is split in a CPU side (prepare), which touches no renderer
+// state and can run on a worker thread during startup, and the texture
+// upload, which needs the renderer.
 
-typedef struct
+Uint32 font_bitmap_pixels[FONT_WIDTH * FONT_HEIGHT];
+
+// The bitmap font is compiled in (src/font_charmap.c), so there is no
+// decoding and no file lookup, only the expansion to RGBA.
+void font_prepare_bitmap(Font *font)
 {
-    SDL_Texture *spritesheet;
-    SDL_Rect glyph_table[ASCII_DISPLAY_HIGH - ASCII_DISPLAY_LOW + 1];
-} Font;
+    *font = (Font){0};
+    for (size_t i = 0; i < FONT_WIDTH * FONT_HEIGHT; ++i)
+    {
+        font_bitmap_pixels[i] = ((Uint32)font_charmap[i] << 24) | 0x00ffffff;
+    }
+    font->spritesheet_size = vec2f(FONT_WIDTH, FONT_HEIGHT);
+    font->glyph_table = font_glyph_table;
+}
 
-Font font_load_from_file(SDL_Renderer *renderer, const char *file_path)
+void font_upload_bitmap(SDL_Renderer *renderer, Font *font)
 {
-    Font font = {0};
-    SDL_Surface *font_surface = surface_from_file(file_path);
-    scc(SDL_SetColorKey(font_surface, SDL_TRUE, 0xFF000000));
-    font.spritesheet = (SDL_Texture *)scp(SDL_CreateTextureFromSurface(renderer, font_surface));
+    font->spritesheet = (SDL_Texture *)scp(SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, FONT_WIDTH, FONT_HEIGHT));
+    scc(SDL_UpdateTexture(font->spritesheet, NULL, font_bitmap_pixels, FONT_WIDTH * (int)sizeof(Uint32)));
+    scc(SDL_SetTextureBlendMode(font->spritesheet, SDL_BLENDMODE_BLEND));
+    // Glyph colors come from the batch vertices, keep the texture itself unmodulated.
+    set_texture_color(font->spritesheet, 0xffffffff);
+}
+
+// Opens the face and rasterizes the printable ASCII range ahead of time, so
+// the first frame does not pay for it.
+bool font_prepare_ttf(Font *font, const char *file_path, uint32_t pixel_size)
+{
+    *font = (Font){0};
+    if (!glyph_atlas_init(&glyph_atlas, file_path))
+    {
+        return false;
+    }
+    font->atlas = &glyph_atlas;
+    font->pixel_size = pixel_size;
+
+    int cell_w, cell_h;
+    glyph_atlas_cell_size(font->atlas, pixel_size, &cell_w, &cell_h, &font->ascender);
+    cell_size = vec2f((float)cell_w, (float)cell_h);
+
+    for (uint32_t codepoint = ASCII_DISPLAY_LOW; codepoint <= ASCII_DISPLAY_HIGH; ++codepoint)
+    {
+        glyph_atlas_get(font->atlas, codepoint, pixel_size);
+    }
+    font->spritesheet_size = vec2f(GLYPH_ATLAS_WIDTH, GLYPH_ATLAS_HEIGHT);
+    return true;
+}
 
-    SDL_FreeSurface(font_surface);
+// Uploads the glyphs rasterized since the last sync, one sub-rectangle each.
+// The rest of the atlas texture is never re-uploaded.
+void font_sync_atlas(Font *font)
+{
+    static Uint32 staging[GLYPH_ATLAS_WIDTH * GLYPH_ATLAS_HEIGHT];
 
-    for (size_t ascii = ASCII_DISPLAY_LOW; ascii <= ASCII_DISPLAY_HIGH; ascii++)
+    for (size_t i = 0; i < font->atlas->dirty_count; ++i)
     {
-        size_t index = ascii - ASCII_DISPLAY_LOW;
-        size_t col = index % FONT_COLS;
-        size_t row = index / FONT_COLS;
+        const Glyph_Atlas_Rect *dirty = &font->atlas->dirty[i];
+        for (int y = 0; y < dirty->h; ++y)
+        {
+            const uint8_t *coverage = &font->atlas->pixels[(size_t)(dirty->y + y) * GLYPH_ATLAS_WIDTH + (size_t)dirty->x];
+            Uint32 *row = &staging[(size_t)y * (size_t)dirty->w];
+            for (int x = 0; x < dirty->w; ++x)
+            {
+                row[x] = ((Uint32)coverage[x] << 24) | 0x00ffffff;
+            }
+        }
 
-        font.glyph_table[index] = (SDL_Rect){
-            .x = (int)(col * FONT_CHAR_WIDTH),
-            .y = (int)(row * FONT_CHAR_HEIGHT),
-            .w = FONT_CHAR_WIDTH,
-            .h = FONT_CHAR_HEIGHT};
+        const SDL_Rect rect = {dirty->x, dirty->y, dirty->w, dirty->h};
+        scc(SDL_UpdateTexture(font->spritesheet, &rect, staging, dirty->w * (int)sizeof(Uint32)));
     }
-    return font;
+    glyph_atlas_clear_dirty(font->atlas);
+}
+
+void font_upload_ttf(SDL_Renderer *renderer, Font *font)
+{
+    font->spritesheet = (SDL_Texture *)scp(SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, GLYPH_ATLAS_WIDTH, GLYPH_ATLAS_HEIGHT));
+    scc(SDL_SetTextureBlendMode(font->spritesheet, SDL_BLENDMODE_BLEND));
+    set_texture_color(font->spritesheet, 0xffffffff);
+    font_sync_atlas(font);
 }
 
-void render_char(SDL_Renderer *renderer, Font *font, char c, Vec2f pos, float scale)
+#define GLYPH_BATCH_CAPACITY (32 * 1024)
+
+// Accumulates textured quads and submits them with a single
+// SDL_RenderGeometry call per flush. The batch is flushed when the texture
+// changes, when it fills up, and once at the end of the frame.
+typedef struct
 {
-    const size_t index = c - ASCII_DISPLAY_LOW;
+    SDL_Renderer *renderer;
+    SDL_Texture *texture;
+    size_t count;
+    SDL_Vertex vertices[GLYPH_BATCH_CAPACITY * 4];
+    int indices[GLYPH_BATCH_CAPACITY * 6];
+} Glyph_Batch;
 
-    const SDL_Rect dst = {
-        .x = (int)pos.x,
-        .y = (int)pos.y,
-        .w = (int)floorf(FONT_CHAR_WIDTH * scale),
-        .h = (int)floorf(FONT_CHAR_HEIGHT * scale)};
+Glyph_Batch glyph_batch = {0};
 
-    assert(c >= ASCII_DISPLAY_LOW && c <= ASCII_DISPLAY_HIGH);
-    scc(SDL_RenderCopy(renderer, font->spritesheet, &font->glyph_table[index], &dst));
+void glyph_batch_init(Glyph_Batch *batch, SDL_Renderer *renderer)
+{
+    batch->renderer = renderer;
+    batch->texture = NULL;
+    batch->count = 0;
+    for (int quad = 0; quad < GLYPH_BATCH_CAPACITY; ++quad)
+    {
+        int *indices = &batch->indices[quad * 6];
+        indices[0] = quad * 4 + 0;
+        indices[1] = quad * 4 + 1;
+        indices[2] = quad * 4 + 2;
+        indices[3] = quad * 4 + 2;
+        indices[4] = quad * 4 + 1;
+        indices[5] = quad * 4 + 3;
+    }
 }
 
-void set_texture_color(SDL_Texture *texture, Uint32 color)
+void glyph_batch_flush(Glyph_Batch *batch)
 {
-    scc(SDL_SetTextureColorMod(texture, (color >> (8 * 0) & 0xff), (color >> (8 * 1) & 0xff), (color >> (8 * 2) & 0xff)));
-    SDL_SetTextureAlphaMod(texture, (color >> (8 * 3) & 0xff));
+    if (batch->count > 0)
+    {
+        const Profiler_Phase phase = profiler_enter(PROFILER_PHASE_SUBMIT);
+        scc(SDL_RenderGeometry(batch->renderer, batch->texture,
+                               batch->vertices, (int)(batch->count * 4),
+                               batch->indices, (int)(batch->count * 6)));
+        profiler_count(PROFILER_COUNTER_DRAW_CALLS, 1);
+        profiler_count(PROFILER_COUNTER_GLYPHS, batch->count);
+        profiler_enter(phase);
+        batch->count = 0;
+    }
 }
 
-void render_text_sized(SDL_Renderer *renderer, Font *font, const char *text, size_t text_size, Vec2f pos, Uint32 color, float scale)
+void glyph_batch_push(Glyph_Batch *batch, SDL_Texture *texture, SDL_FRect uv, SDL_FRect dst, Uint32 color)
 {
+    if (texture != batch->texture)
+    {
+        glyph_batch_flush(batch);
+        batch->texture = texture;
+    }
+    if (batch->count >= GLYPH_BATCH_CAPACITY)
+    {
+        glyph_batch_flush(batch);
+    }
+
+    const SDL_Color c = {
+        .r = color >> (8 * 0) & 0xff,
+        .g = color >> (8 * 1) & 0xff,
+        .b = color >> (8 * 2) & 0xff,
+        .a = color >> (8 * 3) & 0xff};
+
+    SDL_Vertex *v = &batch->vertices[batch->count * 4];
+    v[0] = (SDL_Vertex){{dst.x, dst.y}, c, {uv.x, uv.y}};
+    v[1] = (SDL_Vertex){{dst.x + dst.w, dst.y}, c, {uv.x + uv.w, uv.y}};
+    v[2] = (SDL_Vertex){{dst.x, dst.y + dst.h}, c, {uv.x, uv.y + uv.h}};
+    v[3] = (SDL_Vertex){{dst.x + dst.w, dst.y + dst.h}, c, {uv.x + uv.w, uv.y + uv.h}};
+    batch->count += 1;
+}
+
+void render_char(Glyph_Batch *batch, Font *font, uint32_t codepoint, Vec2f pos, Uint32 color, float scale)
+{
+    if (font->atlas)
+    {
+        const Glyph_Atlas_Entry *glyph = glyph_atlas_get(font->atlas, codepoint, font->pixel_size);
+        if (glyph == NULL || glyph->rect.w == 0 || glyph->rect.h == 0)
+        {
+            return;
+        }
+        if (font->atlas->dirty_count > 0)
+        {
+            font_sync_atlas(font);
+        }
+
+        const SDL_FRect uv = {
+            .x = (float)glyph->rect.x / font->spritesheet_size.x,
+            .y = (float)glyph->rect.y / font->spritesheet_size.y,
+            .w = (float)glyph->rect.w / font->spritesheet_size.x,
+            .h = (float)glyph->rect.h / font->spritesheet_size.y};
+
+        const SDL_FRect dst = {
+            .x = floorf(pos.x) + (float)glyph->bearing_x,
+            .y = floorf(pos.y) + (float)(font->ascender - glyph->bearing_y),
+            .w = (float)glyph->rect.w,
+            .h = (float)glyph->rect.h};
+
+        glyph_batch_push(batch, font->spritesheet, uv, dst, color);
+        return;
+    }
+
+    if (codepoint < ASCII_DISPLAY_LOW || codepoint > ASCII_DISPLAY_HIGH)
+    {
+        codepoint = '?';
+    }
+    const Font_Glyph_Rect *src = &font->glyph_table[codepoint - ASCII_DISPLAY_LOW];
 
-    set_texture_color(font->spritesheet, color);
+    const SDL_FRect uv = {
+        .x = (float)src->x / font->spritesheet_size.x,
+        .y = (float)src->y / font->spritesheet_size.y,
+        .w = (float)src->w / font->spritesheet_size.x,
+        .h = (float)src->h / font->spritesheet_size.y};
 
+    const SDL_FRect dst = {
+        .x = floorf(pos.x),
+        .y = floorf(pos.y),
+        .w = floorf(FONT_CHAR_WIDTH * scale),
+        .h = floorf(FONT_CHAR_HEIGHT * scale)};
+
+    glyph_batch_push(batch, font->spritesheet, uv, dst, color);
+}
+
+void render_text_sized(Glyph_Batch *batch, Font *font, const char *text, size_t text_size, Vec2f pos, Uint32 color, float scale)
+{
     Vec2f pen = pos;
-    for (size_t i = 0; i < text_size; i++)
+    size_t i = 0;
+    while (i < text_size)
     {
-        render_char(renderer, font, text[i], pen, scale);
-        pen = vec2f_add(pen, vec2f(FONT_CHAR_WIDTH * scale, 0));
+        uint32_t codepoint = (unsigned char)text[i];
+        if (font->atlas)
+        {
+            i += utf8_decode(text + i, text_size - i, &codepoint);
+        }
+        else
+        {
+            i += 1;
+        }
+        render_char(batch, font, codepoint, pen, color, scale);
+        pen = vec2f_add(pen, vec2f(cell_size.x, 0));
     }
 }
 
-void render_text(SDL_Renderer *renderer, Font *font, const char *text, Vec2f pos, Uint32 color, float scale)
+void render_text(Glyph_Batch *batch, Font *font, const char *text, Vec2f pos, Uint32 color, float scale)
 {
-    render_text_sized(renderer, font, text, strlen(text), pos, color, scale);
+    render_text_sized(batch, font, text, strlen(text), pos, color, scale);
 }
 
 #define BUFFER_CAPACITY 1024
 
 Editor editor = {0};
 Vec2f camera_pos = {0};
-Vec2f camera_vel = {0};
 
-void move_cursor_left()
+// The camera is simulated in fixed steps of real time and drawn at
+// camera_pos, interpolated between the last two steps, so its motion does
+// not depend on how often frames are rendered.
+typedef struct
+{
+    Vec2f prev_pos;
+    Vec2f pos;
+    Vec2f vel;
+    float accumulator;
+} Camera_Sim;
+
+Camera_Sim camera_sim = {0};
+
+// Rows of the buffer that changed since the last presented frame. Anything
+// that moves the view (camera, resize, expose) damages the whole window.
+typedef struct
+{
+    bool dirty;
+    bool full;
+    size_t row_begin;
+    size_t row_end;
+} Damage;
+
+Damage damage = {.dirty = true, .full = true};
+
+void damage_all(void)
+{
+    damage.dirty = true;
+    damage.full = true;
+}
+
+void damage_rows(size_t begin, size_t end)
+{
+    if (!damage.dirty)
+    {
+        damage.row_begin = begin;
+        damage.row_end = end;
+    }
+    else
+    {
+        if (begin < damage.row_begin)
+        {
+            damage.row_begin = begin;
+        }
+        if (end > damage.row_end)
+        {
+            damage.row_end = end;
+        }
+    }
+    damage.dirty = true;
+}
+
+void damage_clear(void)
+{
+    damage = (Damage){0};
+}
+
+#define ZOOM_MIN 0.25f
+#define ZOOM_MAX 8.0f
+#define ZOOM_STEP 1.1f
+
+// Only the instanced GL renderer can zoom: the other backends bake the
+// glyph size into cached textures.
+bool zoom_enabled = false;
+float zoom = 1.0f;
+// Raised above ZOOM_MIN by view_fit_zoom when the window would show more
+// cells than the instanced renderer holds.
+float zoom_min = ZOOM_MIN;
+Vec2f cell_base_size = {FONT_CHAR_WIDTH * FONT_SCALE, FONT_CHAR_HEIGHT * FONT_SCALE};
+
+void set_zoom(float new_zoom)
+{
+    if (new_zoom > ZOOM_MAX)
+    {
+        new_zoom = ZOOM_MAX;
+    }
+    if (new_zoom < zoom_min)
+    {
+        new_zoom = zoom_min;
+    }
+
+    // Scale the camera with the cells so the view stays on the same text.
+    const Vec2f ratio = vec2fs(new_zoom / zoom);
+    camera_sim.prev_pos = vec2f_mul(camera_sim.prev_pos, ratio);
+    camera_sim.pos = vec2f_mul(camera_sim.pos, ratio);
+    camera_pos = vec2f_mul(camera_pos, ratio);
+    zoom = new_zoom;
+    cell_size = vec2f_mul(cell_base_size, vec2fs(zoom));
+    damage_all();
+}
+
+// Drawable pixels per window coordinate, 2 on most HiDPI displays.
+float pixel_scale = 1.0f;
+// Whole pixels per bitmap font pixel at the current pixel scale.
+int glyph_scale = FONT_SCALE;
+
+// Glyphs are rasterized for the pixel scale instead of being stretched from
+// scale 1: the bitmap font by a whole factor, TrueType at the matching pixel
+// size, SDF at any size. The caches that depend on the glyph size (glyph
+// atlas, row tiles, soft atlases) are keyed by it, so going back to a display
+// seen before reuses what is still cached.
+void set_pixel_scale(float new_scale)
+{
+    glyph_scale = (int)lroundf(FONT_SCALE * new_scale);
+    if (glyph_scale < 1)
+    {
+        glyph_scale = 1;
+    }
+
+    Vec2f base = vec2f((float)(FONT_CHAR_WIDTH * glyph_scale), (float)(FONT_CHAR_HEIGHT * glyph_scale));
+    if (sdf_atlas.cell_width > 0)
+    {
+        const float size = FONT_TTF_PIXEL_SIZE * new_scale / SDF_ATLAS_PIXEL_SIZE;
+        base = vec2f((float)sdf_atlas.cell_width * size, (float)sdf_atlas.cell_height * size);
+    }
+    else if (font.atlas)
+    {
+        int cell_w, cell_h;
+        font.pixel_size = (uint32_t)lroundf(FONT_TTF_PIXEL_SIZE * new_scale);
+        glyph_atlas_cell_size(font.atlas, font.pixel_size, &cell_w, &cell_h, &font.ascender);
+        base = vec2f((float)cell_w, (float)cell_h);
+    }
+
+    // The camera is in pixels too, keep it on the same text.
+    const Vec2f new_cell_size = vec2f_mul(base, vec2fs(zoom));
+    const Vec2f ratio = vec2f_div(new_cell_size, cell_size);
+    camera_sim.prev_pos = vec2f_mul(camera_sim.prev_pos, ratio);
+    camera_sim.pos = vec2f_mul(camera_sim.pos, ratio);
+    camera_pos = vec2f_mul(camera_pos, ratio);
+
+    pixel_scale = new_scale;
+    cell_base_size = base;
+    cell_size = new_cell_size;
+    damage_all();
+}
+
+void move_cursor_left(void)
 {
     if (editor.cursor_col > 0)
     {
@@ -159,12 +458,12 @@ void move_cursor_left()
     }
 }
 
-void move_cursor_right()
+void move_cursor_right(void)
 {
     editor.cursor_col += 1;
 }
 
-void move_cursor_up()
+void move_cursor_up(void)
 {
     if (editor.cursor_row > 0)
     {
@@ -172,228 +471,1941 @@ void move_cursor_up()
     }
 }
 
-void move_cursor_down()
+void move_cursor_down(void)
 {
     editor.cursor_row += 1;
 }
 
-Vec2f window_size(SDL_Window *window)
+// Column of the cell the cursor is drawn in. With the TrueType font lines are
+// laid out per codepoint, so the byte column has to be converted.
+size_t cursor_cell_col(void)
+{
+    if (font.atlas && editor.cursor_row < editor.size)
+    {
+        const Line *line = &editor.lines[editor.cursor_row];
+        if (editor.cursor_col <= line->size)
+        {
+            return utf8_count(line->chars, editor.cursor_col);
+        }
+        return utf8_count(line->chars, line->size) + (editor.cursor_col - line->size);
+    }
+    return editor.cursor_col;
+}
+
+// Range of cells of size `cell` along one axis that intersect the window
+// extent centered on `center`, clamped to [0, limit).
+void visible_cell_range(float center, float extent, float cell, size_t limit, size_t *begin, size_t *end)
+{
+    const float first = floorf((center - extent * 0.5f) / cell);
+    const float last = ceilf((center + extent * 0.5f) / cell);
+
+    *begin = first > 0.0f ? (size_t)first : 0;
+    *end = last > 0.0f ? (size_t)last : 0;
+    if (*end > limit)
+    {
+        *end = limit;
+    }
+    if (*begin > *end)
+    {
+        *begin = *end;
+    }
+}
+
+// Window metrics and camera transform of the frame being rendered. The
+// window is only queried when its size changes, the rest is derived once per
+// frame by view_update. Render functions take projection and visible ranges
+// from here and nowhere else. Everything is in drawable pixels.
+typedef struct
+{
+    Vec2f size;
+    Vec2i drawable_size;
+    float pixel_scale;
+
+    Vec2f camera;
+    // Window position of the buffer origin.
+    Vec2f origin;
+    size_t row_begin;
+    size_t row_end;
+    // Columns that intersect the window, not clamped to any line.
+    size_t col_begin;
+    size_t col_end;
+} View;
+
+View view = {0};
+
+void view_resize(View *view, SDL_Window *window)
+{
+    int window_w, window_h, w, h;
+    SDL_GetWindowSize(window, &window_w, &window_h);
+    SDL_Renderer *renderer = SDL_GetRenderer(window);
+    if (renderer != NULL)
+    {
+        scc(SDL_GetRendererOutputSize(renderer, &w, &h));
+    }
+    else if (SDL_GetWindowFlags(window) & SDL_WINDOW_OPENGL)
+    {
+        SDL_GL_GetDrawableSize(window, &w, &h);
+    }
+    else
+    {
+        // The window surface has the window's size.
+        w = window_w;
+        h = window_h;
+    }
+
+    view->size = vec2f((float)w, (float)h);
+    view->drawable_size = vec2i(w, h);
+    view->pixel_scale = window_w > 0 ? (float)w / (float)window_w : 1.0f;
+}
+
+void view_update(View *view)
+{
+    view->camera = camera_pos;
+    view->origin = vec2f_sub(vec2f_mul(view->size, vec2fs(0.5f)), camera_pos);
+    visible_cell_range(camera_pos.y, view->size.y, cell_size.y, editor.size, &view->row_begin, &view->row_end);
+    visible_cell_range(camera_pos.x, view->size.x, cell_size.x, SIZE_MAX, &view->col_begin, &view->col_end);
+}
+
+Vec2f view_project_point(const View *view, Vec2f point)
 {
-    int w, h;
-    SDL_GetWindowSize(window, &w, &h);
-    return vec2f((float)w, (float)h);
+    return vec2f_add(view->origin, point);
 }
 
-Vec2f camera_project_point(SDL_Window *window, Vec2f point)
+void view_visible_cols(const View *view, size_t line_size, size_t *begin, size_t *end)
 {
-    return vec2f_add(vec2f_mul(window_size(window), vec2fs(0.5f)),
-                     vec2f_sub(point, camera_pos));
+    *begin = view->col_begin < line_size ? view->col_begin : line_size;
+    *end = view->col_end < line_size ? view->col_end : line_size;
 }
 
 #define UNHEX(color) (color) >> (8 * 0) & 0xff, (color >> (8 * 1) & 0xff), (color >> (8 * 2) & 0xff), (color >> (8 * 3) & 0xff)
 
-void render_cursor(SDL_Renderer *renderer, SDL_Window *window, Font *font)
+// The cursor block is filled before the text and its glyph is pushed into the
+// same batch after the line glyphs, so the whole frame stays at one fill plus
+// one geometry submission.
+void render_cursor_rect(SDL_Renderer *renderer, const View *view)
 {
     const Vec2f pos =
-        camera_project_point(window, vec2f((float)editor.cursor_col * FONT_CHAR_WIDTH * FONT_SCALE, (float)editor.cursor_row * FONT_CHAR_HEIGHT * FONT_SCALE));
+        view_project_point(view, vec2f((float)cursor_cell_col() * cell_size.x, (float)editor.cursor_row * cell_size.y));
     SDL_Rect rect = {
         .x = (int)floorf(pos.x),
         .y = (int)floorf(pos.y),
-        .w = FONT_CHAR_WIDTH * FONT_SCALE,
-        .h = FONT_CHAR_HEIGHT * FONT_SCALE};
+        .w = (int)cell_size.x,
+        .h = (int)cell_size.y};
 
     scc(SDL_SetRenderDrawColor(renderer, UNHEX(0xffffffff)));
     scc(SDL_RenderFillRect(renderer, &rect));
+    profiler_count(PROFILER_COUNTER_DRAW_CALLS, 1);
+}
+
+void render_cursor_glyph(Glyph_Batch *batch, const View *view, Font *font)
+{
     const char *c = editor_char_under_cursor(&editor);
     if (c)
     {
-        set_texture_color(font->spritesheet, 0xff000000);
-        render_char(renderer, font, *c, pos, FONT_SCALE);
-    }
-}
+        const Line *line = &editor.lines[editor.cursor_row];
+        uint32_t codepoint = (unsigned char)*c;
+        if (font->atlas)
+        {
+            utf8_decode(c, line->size - editor.cursor_col, &codepoint);
+        }
 
-void usage(FILE *stream)
-{
-    fprintf(stream, "Usage: text_editor [file]\n");
+        const Vec2f pos =
+            view_project_point(view, vec2f((float)cursor_cell_col() * cell_size.x, (float)editor.cursor_row * cell_size.y));
+        render_char(batch, font, codepoint, pos, 0xff000000, (float)glyph_scale);
+    }
 }
 
-#define OPENGL_RENDERER
+#define PROFILER_OVERLAY_LINES 3
+#define PROFILER_OVERLAY_LINE_CAP 128
 
-#ifdef OPENGL_RENDERER
-void MessageCallback(GLenum source,
-                     GLenum type,
-                     GLuint id,
-                     GLenum severity,
-                     GLsizei length,
-                     const GLchar* message,
-                     const void* userParam)
+// The overlay shows the last presented frame, the one being built is not
+// finished yet. Returns the number of lines, 0 before the first frame.
+size_t profiler_overlay_format(char lines[PROFILER_OVERLAY_LINES][PROFILER_OVERLAY_LINE_CAP])
 {
-    (void) source;
-    (void) id;
-    (void) length;
-    (void) userParam;
-    fprintf(stderr, "GL CALLBACK: %s type = 0x%x, severity = 0x%x, message = %s\n",
-            (type == GL_DEBUG_TYPE_ERROR ? "** GL ERROR **" : ""),
-            type, severity, message);
+    const Profiler_Frame *frame = profiler_last_frame();
+    if (frame == NULL)
+    {
+        return 0;
+    }
+
+    double p50, p99;
+    profiler_frame_percentiles(&p50, &p99);
+
+    snprintf(lines[0], PROFILER_OVERLAY_LINE_CAP, "frame %.2fms p50 %.2fms p99 %.2fms",
+             frame->frame_ms, p50, p99);
+    snprintf(lines[1], PROFILER_OVERLAY_LINE_CAP, "event %.2f update %.2f render %.2f submit %.2f present %.2f",
+             frame->phase_ms[PROFILER_PHASE_EVENT],
+             frame->phase_ms[PROFILER_PHASE_UPDATE],
+             frame->phase_ms[PROFILER_PHASE_RENDER],
+             frame->phase_ms[PROFILER_PHASE_SUBMIT],
+             frame->phase_ms[PROFILER_PHASE_PRESENT]);
+    snprintf(lines[2], PROFILER_OVERLAY_LINE_CAP, "draws %llu glyphs %llu allocs %llu",
+             (unsigned long long)frame->counters[PROFILER_COUNTER_DRAW_CALLS],
+             (unsigned long long)frame->counters[PROFILER_COUNTER_GLYPHS],
+             (unsigned long long)frame->counters[PROFILER_COUNTER_ALLOCATIONS]);
+    return PROFILER_OVERLAY_LINES;
 }
 
-int main(int argc, char **argv)
+void render_profiler_overlay_sdl(SDL_Renderer *renderer, Font *font)
 {
+    char lines[PROFILER_OVERLAY_LINES][PROFILER_OVERLAY_LINE_CAP];
+    const size_t count = profiler_overlay_format(lines);
 
-    (void)argc;
-    (void)argv;
-
-    scc(SDL_Init(SDL_INIT_VIDEO));
+    size_t width = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t n = strlen(lines[i]);
+        width = n > width ? n : width;
+    }
 
-    SDL_Window *window = (SDL_Window *)scp(SDL_CreateWindow("Text Editor", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL));
+    const SDL_Rect rect = {
+        .x = 0,
+        .y = 0,
+        .w = (int)((float)width * cell_size.x),
+        .h = (int)((float)count * cell_size.y)};
+    scc(SDL_SetRenderDrawColor(renderer, UNHEX(0xff000000)));
+    scc(SDL_RenderFillRect(renderer, &rect));
 
+    for (size_t i = 0; i < count; ++i)
     {
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+        render_text(&glyph_batch, font, lines[i], vec2f(0, (float)i * cell_size.y), 0xff00ffff, (float)glyph_scale);
+    }
+    glyph_batch_flush(&glyph_batch);
+}
 
-        int major;
-        int minor;
-        scc(SDL_GL_GetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, &major));
-        scc(SDL_GL_GetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, &minor));
+#define ROW_TILE_ROWS 16
+#define ROW_TILE_COLS 64
+#define ROW_TILE_CACHE_CAP 64
 
-        printf("GL Version %d.%d", major, minor);
+// A block of ROW_TILE_ROWS x ROW_TILE_COLS cells rendered once into an
+// offscreen texture. The signature folds the versions of the block's lines,
+// so an edit only re-renders the tiles it lands in and scrolling is blits.
+// Tiles of another pixel scale stay cached next to the current ones.
+typedef struct
+{
+    SDL_Texture *texture;
+    float pixel_scale;
+    bool valid;
+    size_t block_row;
+    size_t block_col;
+    uint64_t signature;
+    uint64_t last_used;
+    // Set when the renderer has no custom blend modes, see row_tile_get.
+    bool opaque;
+} Row_Tile;
+
+Row_Tile row_tiles[ROW_TILE_CACHE_CAP] = {0};
+uint64_t row_tiles_frame = 0;
+
+void row_tiles_invalidate(void)
+{
+    for (size_t i = 0; i < ROW_TILE_CACHE_CAP; ++i)
+    {
+        row_tiles[i].valid = false;
     }
+}
 
-    scp(SDL_GL_CreateContext(window));
-
-    GLenum err = glewInit();
+// Returns false when no line of the block reaches into its columns, such a
+// tile would be blank and is not drawn at all.
+bool row_tile_signature(size_t block_row, size_t block_col, uint64_t *signature)
+{
+    const size_t row_begin = block_row * ROW_TILE_ROWS;
+    size_t row_end = row_begin + ROW_TILE_ROWS;
+    if (row_end > editor.size)
+    {
+        row_end = editor.size;
+    }
 
-    if (GLEW_OK != err)
+    bool visible = false;
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t row = row_begin; row < row_end; ++row)
     {
-        fprintf(stderr, "Error: %s\n", glewGetErrorString(err));
-        exit(1);
+        const Line *line = &editor.lines[row];
+        visible = visible || line->size > block_col * ROW_TILE_COLS;
+        hash = (hash ^ line->version) * 1099511628211ULL;
+        hash = (hash ^ line->size) * 1099511628211ULL;
     }
+    hash = (hash ^ (row_end - row_begin)) * 1099511628211ULL;
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    *signature = hash;
+    return visible;
+}
 
-    if(GLEW_ARB_debug_output){
-        glEnable(GL_DEBUG_OUTPUT);
-        glDebugMessageCallback(MessageCallback, 0);
-    } else {
-        fprintf(stderr, "WARNING! GLEW_ARB_debug_output is not available");
-    }
+// Pushes the text of a block to the glyph batch with its top left cell at
+// `origin`.
+void render_block_text(Font *font, size_t block_row, size_t block_col, Vec2f origin)
+{
+    const size_t row_begin = block_row * ROW_TILE_ROWS;
+    const size_t col_begin = block_col * ROW_TILE_COLS;
+    for (size_t row = row_begin; row < row_begin + ROW_TILE_ROWS && row < editor.size; ++row)
+    {
+        const Line *line = &editor.lines[row];
 
-    return 0;
+        size_t byte_begin = col_begin < line->size ? col_begin : line->size;
+        size_t byte_end = col_begin + ROW_TILE_COLS < line->size ? col_begin + ROW_TILE_COLS : line->size;
+        if (font->atlas)
+        {
+            byte_begin = utf8_advance(line->chars, line->size, col_begin);
+            byte_end = byte_begin + utf8_advance(line->chars + byte_begin, line->size - byte_begin, ROW_TILE_COLS);
+        }
+
+        const Vec2f pos = vec2f(origin.x, origin.y + (float)(row - row_begin) * cell_size.y);
+        render_text_sized(&glyph_batch, font, line->chars + byte_begin, byte_end - byte_begin, pos, 0xffffffff, (float)glyph_scale);
+    }
 }
-#else
-int main(int argc, char *argv[])
+
+void row_tile_render(SDL_Renderer *renderer, Font *font, Row_Tile *tile)
 {
-    const char *file_path = NULL;
+    // Glyphs of blocks drawn without a tile belong to the window.
+    glyph_batch_flush(&glyph_batch);
+    scc(SDL_SetRenderTarget(renderer, tile->texture));
+    scc(SDL_SetRenderDrawColor(renderer, 0, 0, 0, tile->opaque ? 0xff : 0));
+    scc(SDL_RenderClear(renderer));
+
+    render_block_text(font, tile->block_row, tile->block_col, vec2fs(0.0f));
+    glyph_batch_flush(&glyph_batch);
+
+    scc(SDL_SetRenderTarget(renderer, NULL));
+}
 
-    if (argc > 1)
+Row_Tile *row_tile_get(SDL_Renderer *renderer, Font *font, size_t block_row, size_t block_col, uint64_t signature)
+{
+    Row_Tile *victim = NULL;
+    for (size_t i = 0; i < ROW_TILE_CACHE_CAP; ++i)
+    {
+        Row_Tile *tile = &row_tiles[i];
+        if (tile->valid && tile->block_row == block_row && tile->block_col == block_col && tile->pixel_scale == pixel_scale)
+        {
+            victim = tile;
+            break;
+        }
+        if (tile->last_used < row_tiles_frame &&
+            (victim == NULL || !tile->valid || (victim->valid && tile->last_used < victim->last_used)))
+        {
+            victim = tile;
+        }
+    }
+    if (victim == NULL)
     {
-        file_path = argv[1];
+        return NULL;
     }
 
-    if (file_path)
+    if (victim->texture != NULL && victim->pixel_scale != pixel_scale)
     {
-        FILE *f = fopen(file_path, "r");
-        if (f != NULL)
+        SDL_DestroyTexture(victim->texture);
+        victim->texture = NULL;
+        victim->valid = false;
+    }
+    if (victim->texture == NULL)
+    {
+        victim->pixel_scale = pixel_scale;
+        victim->texture = (SDL_Texture *)scp(SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                                               (int)(ROW_TILE_COLS * cell_size.x), (int)(ROW_TILE_ROWS * cell_size.y)));
+
+        // Glyphs blended onto transparent black leave premultiplied color in
+        // the tile, so it is composited without multiplying by alpha again
+        // and edges match glyphs drawn straight to the window. Renderers
+        // without custom blend modes (software) get opaque black tiles
+        // copied as is instead.
+        const SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+        victim->opaque = SDL_SetTextureBlendMode(victim->texture, premultiplied) < 0;
+        if (victim->opaque)
         {
-            editor_load_from_file(&editor, f);
-            fclose(f);
+            scc(SDL_SetTextureBlendMode(victim->texture, SDL_BLENDMODE_NONE));
         }
     }
 
-    scc(SDL_Init(SDL_INIT_VIDEO));
+    victim->last_used = row_tiles_frame;
+    if (!victim->valid || victim->block_row != block_row || victim->block_col != block_col || victim->signature != signature)
+    {
+        victim->valid = true;
+        victim->block_row = block_row;
+        victim->block_col = block_col;
+        victim->signature = signature;
+        row_tile_render(renderer, font, victim);
+    }
+    return victim;
+}
 
-    SDL_Window *window = (SDL_Window *)scp(SDL_CreateWindow("Text Editor", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_RESIZABLE));
+void render_editor_sdl(SDL_Renderer *renderer, const View *view, Font *font)
+{
+    row_tiles_frame += 1;
+    if (font->atlas)
+    {
+        glyph_atlas_begin_frame(font->atlas);
+    }
 
-    SDL_Renderer *renderer = (SDL_Renderer *)scp(SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED));
+    const size_t row_begin = view->row_begin;
+    const size_t row_end = view->row_end;
+    const size_t col_begin = view->col_begin;
+    const size_t col_end = view->col_end;
 
-    Font font = font_load_from_file(renderer, "./charmap-oldschool_white.png");
+    scc(SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0));
+    scc(SDL_RenderClear(renderer));
 
-    bool quit = false;
-    while (!quit)
+    if (row_begin < row_end && col_begin < col_end)
     {
-        const Uint32 start = SDL_GetTicks();
-        SDL_Event event = {0};
-        while (SDL_PollEvent(&event))
+        for (size_t block_row = row_begin / ROW_TILE_ROWS; block_row <= (row_end - 1) / ROW_TILE_ROWS; ++block_row)
         {
-            switch (event.type)
+            for (size_t block_col = col_begin / ROW_TILE_COLS; block_col <= (col_end - 1) / ROW_TILE_COLS; ++block_col)
             {
-            case SDL_QUIT:
-                quit = true;
-                break;
-            case SDL_KEYDOWN:
-                switch (event.key.keysym.sym)
+                uint64_t signature;
+                if (!row_tile_signature(block_row, block_col, &signature))
                 {
-                case SDLK_BACKSPACE:
-                    editor_backspace(&editor);
-                    break;
-                case SDLK_LEFT:
-                    move_cursor_left();
-                    break;
-                case SDLK_RIGHT:
-                    move_cursor_right();
-                    break;
-                case SDLK_DELETE:
-                    editor_delete(&editor);
-                    break;
-                case SDLK_ESCAPE:
-                    quit = true;
-                    break;
-                case SDLK_UP:
-                    move_cursor_up(&editor);
-                    break;
-                case SDLK_DOWN:
-                    move_cursor_down(&editor);
-                    break;
-                case SDLK_RETURN:
-                    editor_insert_new_line(&editor);
-                    break;
-                case SDLK_F2:
-                    if (file_path)
-                    {
-                        editor_save_to_file(&editor, file_path);
-                    }
-                    break;
+                    continue;
                 }
-                break;
-            case SDL_TEXTINPUT:
-                editor_insert_text_before_cursor(&editor, event.text.text);
-                // cursor += strlen(event.text.text);
-                break;
+
+                const Vec2f pos = view_project_point(view, vec2f((float)(block_col * ROW_TILE_COLS) * cell_size.x,
+                                                                 (float)(block_row * ROW_TILE_ROWS) * cell_size.y));
+                const Row_Tile *tile = row_tile_get(renderer, font, block_row, block_col, signature);
+                if (tile == NULL)
+                {
+                    // More blocks are visible than the cache holds, the rest
+                    // is drawn straight from the glyph batch.
+                    render_block_text(font, block_row, block_col, vec2f(floorf(pos.x), floorf(pos.y)));
+                    continue;
+                }
+
+                const SDL_Rect dst = {
+                    .x = (int)floorf(pos.x),
+                    .y = (int)floorf(pos.y),
+                    .w = (int)(ROW_TILE_COLS * cell_size.x),
+                    .h = (int)(ROW_TILE_ROWS * cell_size.y)};
+                const Profiler_Phase phase = profiler_enter(PROFILER_PHASE_SUBMIT);
+                scc(SDL_RenderCopy(renderer, tile->texture, NULL, &dst));
+                profiler_count(PROFILER_COUNTER_DRAW_CALLS, 1);
+                profiler_enter(phase);
+            }
+        }
+    }
+    glyph_batch_flush(&glyph_batch);
+
+    render_cursor_rect(renderer, view);
+    render_cursor_glyph(&glyph_batch, view, font);
+    glyph_batch_flush(&glyph_batch);
+
+    if (profiler.overlay)
+    {
+        render_profiler_overlay_sdl(renderer, font);
+    }
+}
+
+Tile_Glyph_Buffer tile_glyph_buffer = {0};
+Tile_Line_Cache tile_line_cache = {0};
+Job_Pool render_pool = {0};
+
+// Whether every row visible at zoom `z` gets its own tile_line_cache run
+// and every visible cell, the cursor and the overlay fit in the instance
+// buffer. Bounds as in visible_cell_range, runs are widened by up to a
+// column chunk on each side.
+bool view_zoom_fits(const View *view, float z)
+{
+    const Vec2f cell = vec2f_mul(cell_base_size, vec2fs(z));
+    const size_t rows = (size_t)ceilf(view->size.y / cell.y) + 1;
+    const size_t cols = (size_t)ceilf(view->size.x / cell.x) + 1 + 2 * (TILE_LINE_RUN_COL_CHUNK - 1);
+    return rows <= TILE_LINE_CACHE_CAP &&
+           rows * cols + 1 + PROFILER_OVERLAY_LINES * PROFILER_OVERLAY_LINE_CAP <= TILE_GLYPH_BUFFER_CAP;
+}
+
+// Call whenever the view size or the cell size at zoom 1 changes. Zooming
+// out stops where render_editor_gl could not draw the whole window anymore.
+void view_fit_zoom(const View *view)
+{
+    if (!zoom_enabled)
+    {
+        return;
+    }
+
+    zoom_min = ZOOM_MIN;
+    while (!view_zoom_fits(view, zoom_min))
+    {
+        zoom_min *= ZOOM_STEP;
+    }
+    if (zoom < zoom_min)
+    {
+        set_zoom(zoom_min);
+    }
+}
+
+#define RENDER_JOB_ROWS 32
+
+// Visible rows are refreshed in jobs of RENDER_JOB_ROWS rows on
+// render_pool. Each job only touches the cache runs of its own rows and
+// reads the editor, which does not change while a frame is built.
+typedef struct
+{
+    const View *view;
+    size_t row_begin;
+    size_t row_end;
+    const Tile_Line_Run *runs[TILE_LINE_CACHE_CAP];
+    Tile_Line_Cache_Stats stats[TILE_LINE_CACHE_CAP / RENDER_JOB_ROWS];
+} Render_Runs;
+
+Render_Runs render_runs = {0};
+
+void render_runs_job(void *data, size_t job)
+{
+    Render_Runs *r = (Render_Runs *)data;
+    const size_t begin = r->row_begin + job * RENDER_JOB_ROWS;
+    const size_t end = begin + RENDER_JOB_ROWS < r->row_end ? begin + RENDER_JOB_ROWS : r->row_end;
+
+    r->stats[job] = (Tile_Line_Cache_Stats){0};
+    for (size_t row = begin; row < end; ++row)
+    {
+        const Line *line = &editor.lines[row];
+        size_t col_begin, col_end;
+        view_visible_cols(r->view, line->size, &col_begin, &col_end);
+        r->runs[row - r->row_begin] = tile_line_cache_get(&tile_line_cache, row, line->version,
+                                                          line->chars, line->size, col_begin, col_end, &r->stats[job]);
+    }
+}
+
+// The whole frame, cursor included, is a single instanced draw: the cursor
+// is one more glyph with an opaque background pushed after the text.
+//
+// Line runs come from tile_line_cache, so the instance buffer is only
+// reassembled when a visible line changed or the visible rows did. Pure
+// camera movement just updates the camera uniform.
+void render_editor_gl(Tile_Glyph_Buffer *buffer, const View *view)
+{
+    static size_t prev_row_begin = 0;
+    static size_t prev_row_end = 0;
+
+    glViewport(0, 0, view->drawable_size.x, view->drawable_size.y);
+
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // view_fit_zoom keeps the visible rows within TILE_LINE_CACHE_CAP and
+    // their glyphs within TILE_GLYPH_BUFFER_CAP.
+    const size_t row_begin = view->row_begin;
+    const size_t row_end = view->row_end;
+
+    bool rebuilt = row_begin != prev_row_begin || row_end != prev_row_end || buffer->count == 0;
+    render_runs.view = view;
+    render_runs.row_begin = row_begin;
+    render_runs.row_end = row_end;
+    const size_t jobs_count = (row_end - row_begin + RENDER_JOB_ROWS - 1) / RENDER_JOB_ROWS;
+    job_pool_run(&render_pool, render_runs_job, &render_runs, jobs_count);
+    for (size_t job = 0; job < jobs_count; ++job)
+    {
+        rebuilt = rebuilt || render_runs.stats[job].rebuilt;
+        profiler_count(PROFILER_COUNTER_ALLOCATIONS, render_runs.stats[job].allocations);
+    }
+    prev_row_begin = row_begin;
+    prev_row_end = row_end;
+
+    const char *c = editor_char_under_cursor(&editor);
+    const Tile_Glyph cursor = {
+        .tile = vec2i((int)editor.cursor_col, (int)editor.cursor_row),
+        .ch = c ? (unsigned char)*c : ' ',
+        .fg_color = 0xff000000,
+        .bg_color = 0xffffffff,
+    };
+
+    bool changed = rebuilt;
+    if (rebuilt)
+    {
+        tile_glyph_buffer_clear(buffer);
+        for (size_t row = row_begin; row < row_end; ++row)
+        {
+            tile_glyph_buffer_push_run(buffer, render_runs.runs[row - row_begin]);
+        }
+        tile_glyph_buffer_push(buffer, cursor);
+    }
+    else if (memcmp(&buffer->glyphs[buffer->count - 1], &cursor, sizeof(cursor)) != 0)
+    {
+        buffer->glyphs[buffer->count - 1] = cursor;
+        changed = true;
+    }
+
+    // Overlay glyphs go after the frame's instances and are dropped again
+    // once submitted, so the cached layout (cursor last) is left intact.
+    const size_t frame_count = buffer->count;
+    if (profiler.overlay)
+    {
+        char lines[PROFILER_OVERLAY_LINES][PROFILER_OVERLAY_LINE_CAP];
+        const size_t count = profiler_overlay_format(lines);
+        for (size_t i = 0; i < count; ++i)
+        {
+            tile_glyph_render_line_sized(buffer, lines[i], strlen(lines[i]), vec2i(0, (int)i), 0xff00ffff, 0xff000000);
+        }
+        changed = true;
+    }
+
+    // Any change streams the whole frame into the next ring region, a region
+    // the GPU may still be reading from is never written.
+    const Profiler_Phase phase = profiler_enter(PROFILER_PHASE_SUBMIT);
+    if (changed)
+    {
+        tile_glyph_buffer_sync(buffer);
+    }
+    tile_glyph_buffer_draw_range(buffer, 0, frame_count, view->size, view->camera, cell_size);
+    if (buffer->count > frame_count)
+    {
+        // The camera at half the resolution makes tiles screen-space cells,
+        // at the unzoomed size.
+        const Vec2f resolution = view->size;
+        tile_glyph_buffer_draw_range(buffer, frame_count, buffer->count - frame_count, resolution, vec2f_mul(resolution, vec2fs(0.5f)), cell_base_size);
+    }
+    tile_glyph_buffer_fence(buffer);
+    profiler_enter(phase);
+    buffer->count = frame_count;
+}
+
+Grid_Glyph_Renderer grid_glyph = {0};
+
+// Copies the visible rows into the grid texture and shades the whole window
+// with one fullscreen quad, so the CPU cost does not depend on glyph count.
+void render_editor_gl_grid(Grid_Glyph_Renderer *grid, const View *view)
+{
+    glViewport(0, 0, view->drawable_size.x, view->drawable_size.y);
+
+    const size_t row_begin = view->row_begin;
+    const size_t row_end = view->row_end;
+    const size_t col_begin = view->col_begin;
+    const size_t col_end = view->col_end;
+
+    // The cursor may sit on the empty row past the last line, the grid then
+    // reaches down to it so it gets a cell like in the other renderers.
+    size_t grid_rows = row_end - row_begin;
+    const size_t window_rows = (size_t)ceilf(view->size.y / cell_size.y) + 1;
+    if (editor.cursor_row >= row_end && editor.cursor_row < row_begin + window_rows)
+    {
+        grid_rows = editor.cursor_row - row_begin + 1;
+    }
+
+    grid_glyph_reset(grid, col_end - col_begin, grid_rows);
+    for (size_t row = row_begin; row < row_end; ++row)
+    {
+        const Line *line = &editor.lines[row];
+        if (line->size > col_begin)
+        {
+            grid_glyph_set_text_sized(grid, 0, row - row_begin, line->chars + col_begin, line->size - col_begin);
+        }
+    }
+    if (editor.cursor_row >= row_begin && editor.cursor_col >= col_begin)
+    {
+        grid_glyph_set_attrs(grid, editor.cursor_col - col_begin, editor.cursor_row - row_begin, GRID_GLYPH_ATTR_INVERSE);
+    }
+
+    if (profiler.overlay)
+    {
+        // The grid's first row and column can be partially scrolled out,
+        // the overlay starts at the first fully visible cell.
+        char lines[PROFILER_OVERLAY_LINES][PROFILER_OVERLAY_LINE_CAP];
+        const size_t count = profiler_overlay_format(lines);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t n = strlen(lines[i]);
+            grid_glyph_set_text_sized(grid, 1, 1 + i, lines[i], n);
+            for (size_t col = 1; col < 1 + n; ++col)
+            {
+                grid_glyph_set_attrs(grid, col, 1 + i, GRID_GLYPH_ATTR_INVERSE);
+            }
+        }
+    }
+
+    const Profiler_Phase phase = profiler_enter(PROFILER_PHASE_SUBMIT);
+    grid_glyph_sync(grid);
+
+    const Vec2f origin = view_project_point(view, vec2f((float)col_begin * cell_size.x, (float)row_begin * cell_size.y));
+    grid_glyph_draw(grid, view->size, origin, (float)glyph_scale);
+    profiler_enter(phase);
+}
+
+#define SOFT_ATLASES_CAP 4
+
+// One pre-scaled font per glyph scale seen so far, the oldest is replaced
+// when they are all taken.
+Soft_Glyph_Atlas soft_atlases[SOFT_ATLASES_CAP] = {0};
+size_t soft_atlases_next = 0;
+
+const Soft_Glyph_Atlas *soft_atlas_get(int scale)
+{
+    for (size_t i = 0; i < SOFT_ATLASES_CAP; ++i)
+    {
+        if (soft_atlases[i].coverage != NULL && soft_atlases[i].glyph_width == FONT_CHAR_WIDTH * scale)
+        {
+            return &soft_atlases[i];
+        }
+    }
+
+    Soft_Glyph_Atlas *atlas = &soft_atlases[soft_atlases_next];
+    soft_atlases_next = (soft_atlases_next + 1) % SOFT_ATLASES_CAP;
+    free(atlas->coverage);
+    soft_glyph_atlas_init(atlas, scale);
+    return atlas;
+}
+
+// Only used when the window surface is not 32 bit XRGB, the frame is then
+// rasterized here and converted by SDL_BlitSurface.
+SDL_Surface *soft_surface = NULL;
+
+#define SOFT_BANDS_CAP 2
+
+// Clears the framebuffer rows [top, bottom) and draws everything that
+// intersects them.
+void render_soft_band(Soft_Framebuffer *fb, const View *view, int top, int bottom)
+{
+    const int cell_w = (int)cell_size.x;
+    const int cell_h = (int)cell_size.y;
+    const Soft_Glyph_Atlas *atlas = soft_atlas_get(glyph_scale);
+
+    soft_framebuffer_clip(fb, top, bottom);
+    soft_fill_rect(fb, 0, top, fb->width, bottom - top, 0xff000000);
+
+    for (size_t row = view->row_begin; row < view->row_end; ++row)
+    {
+        const int y = (int)floorf(view->origin.y + (float)row * cell_size.y);
+        if (y + cell_h <= top || y >= bottom)
+        {
+            continue;
+        }
+        const Line *line = &editor.lines[row];
+        size_t col_begin, col_end;
+        view_visible_cols(view, line->size, &col_begin, &col_end);
+        const int x = (int)floorf(view->origin.x + (float)col_begin * cell_size.x);
+        soft_blit_text_sized(fb, atlas, line->chars + col_begin, col_end - col_begin, x, y, cell_w, 0xffffffff);
+    }
+
+    const Vec2f cursor = view_project_point(view, vec2f((float)cursor_cell_col() * cell_size.x, (float)editor.cursor_row * cell_size.y));
+    soft_fill_rect(fb, (int)floorf(cursor.x), (int)floorf(cursor.y), cell_w, cell_h, 0xffffffff);
+    const char *c = editor_char_under_cursor(&editor);
+    if (c)
+    {
+        soft_blit_glyph(fb, atlas, (unsigned char)*c, (int)floorf(cursor.x), (int)floorf(cursor.y), 0xff000000);
+    }
+
+    if (profiler.overlay)
+    {
+        char lines[PROFILER_OVERLAY_LINES][PROFILER_OVERLAY_LINE_CAP];
+        const size_t count = profiler_overlay_format(lines);
+        size_t width = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t n = strlen(lines[i]);
+            width = n > width ? n : width;
+        }
+        soft_fill_rect(fb, 0, 0, (int)width * cell_w, (int)count * cell_h, 0xff000000);
+        for (size_t i = 0; i < count; ++i)
+        {
+            soft_blit_text_sized(fb, atlas, lines[i], strlen(lines[i]), 0, (int)i * cell_h, cell_w, 0xff00ffff);
+        }
+    }
+}
+
+// Rasterizes on the CPU straight into the window surface. Only the damaged
+// rows (and the profiler overlay) are redrawn, the rest of the surface keeps
+// the previous frame. Returns the number of rects to update.
+int render_editor_soft(SDL_Window *window, const View *view, SDL_Rect rects[SOFT_BANDS_CAP])
+{
+    SDL_Surface *surface = (SDL_Surface *)scp(SDL_GetWindowSurface(window));
+    SDL_Surface *target = surface;
+    if (surface->format->format != SDL_PIXELFORMAT_ARGB8888 && surface->format->format != SDL_PIXELFORMAT_RGB888)
+    {
+        if (soft_surface == NULL || soft_surface->w != surface->w || soft_surface->h != surface->h)
+        {
+            SDL_FreeSurface(soft_surface);
+            soft_surface = (SDL_Surface *)scp(SDL_CreateRGBSurfaceWithFormat(0, surface->w, surface->h, 32, SDL_PIXELFORMAT_ARGB8888));
+        }
+        target = soft_surface;
+    }
+
+    int count = 0;
+    if (damage.full)
+    {
+        rects[count++] = (SDL_Rect){0, 0, target->w, target->h};
+    }
+    else
+    {
+        if (damage.row_begin < damage.row_end)
+        {
+            float top = floorf(view->origin.y + (float)damage.row_begin * cell_size.y);
+            float bottom = ceilf(view->origin.y + (float)damage.row_end * cell_size.y);
+            top = top < 0.0f ? 0.0f : top;
+            bottom = bottom > (float)target->h ? (float)target->h : bottom;
+            if (top < bottom)
+            {
+                rects[count++] = (SDL_Rect){0, (int)top, target->w, (int)(bottom - top)};
+            }
+        }
+        if (profiler.overlay)
+        {
+            const int bottom = PROFILER_OVERLAY_LINES * (int)cell_size.y;
+            rects[count++] = (SDL_Rect){0, 0, target->w, bottom < target->h ? bottom : target->h};
+        }
+    }
+
+    if (SDL_MUSTLOCK(target))
+    {
+        scc(SDL_LockSurface(target));
+    }
+    Soft_Framebuffer fb = {
+        .pixels = (uint32_t *)target->pixels,
+        .width = target->w,
+        .height = target->h,
+        .pitch = target->pitch / (int)sizeof(uint32_t),
+    };
+    for (int i = 0; i < count; ++i)
+    {
+        render_soft_band(&fb, view, rects[i].y, rects[i].y + rects[i].h);
+    }
+    if (SDL_MUSTLOCK(target))
+    {
+        SDL_UnlockSurface(target);
+    }
+
+    const Profiler_Phase phase = profiler_enter(PROFILER_PHASE_SUBMIT);
+    for (int i = 0; i < count; ++i)
+    {
+        if (target != surface)
+        {
+            SDL_Rect rect = rects[i];
+            scc(SDL_BlitSurface(target, &rects[i], surface, &rect));
+        }
+        profiler_count(PROFILER_COUNTER_DRAW_CALLS, 1);
+    }
+    profiler_enter(phase);
+    return count;
+}
+
+void MessageCallback(GLenum source,
+                     GLenum type,
+                     GLuint id,
+                     GLenum severity,
+                     GLsizei length,
+                     const GLchar* message,
+                     const void* userParam)
+{
+    (void) source;
+    (void) id;
+    (void) length;
+    (void) userParam;
+    fprintf(stderr, "GL CALLBACK: %s type = 0x%x, severity = 0x%x, message = %s\n",
+            (type == GL_DEBUG_TYPE_ERROR ? "** GL ERROR **" : ""),
+            type, severity, message);
+}
+
+void gl_init(SDL_Window *window)
+{
+    scp(SDL_GL_CreateContext(window));
+
+    {
+        int major;
+        int minor;
+        scc(SDL_GL_GetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, &major));
+        scc(SDL_GL_GetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, &minor));
+
+        printf("GL Version %d.%d\n", major, minor);
+    }
+
+    glewExperimental = GL_TRUE;
+    GLenum err = glewInit();
+
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLX builds of GLEW report this under EGL (e.g. headless Mesa) even
+    // though every entry point was loaded.
+    if (err == GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        err = GLEW_OK;
+    }
+#endif
+
+    if (GLEW_OK != err)
+    {
+        fprintf(stderr, "Error: %s\n", glewGetErrorString(err));
+        exit(1);
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    if(GLEW_ARB_debug_output){
+        glEnable(GL_DEBUG_OUTPUT);
+        glDebugMessageCallback(MessageCallback, 0);
+    } else {
+        fprintf(stderr, "WARNING! GLEW_ARB_debug_output is not available\n");
+    }
+}
+
+typedef enum
+{
+    RENDERER_OPENGL = 0,
+    RENDERER_OPENGL_GRID,
+    RENDERER_SDL,
+    RENDERER_SOFTWARE,
+    RENDERER_TTY,
+} Renderer_Backend;
+
+const char *renderer_backend_name(Renderer_Backend backend)
+{
+    switch (backend)
+    {
+    case RENDERER_OPENGL:
+        return "gl";
+    case RENDERER_OPENGL_GRID:
+        return "grid";
+    case RENDERER_SDL:
+        return "sdl";
+    case RENDERER_SOFTWARE:
+        return "soft";
+    case RENDERER_TTY:
+        return "tty";
+    default:
+        return "unknown";
+    }
+}
+
+void usage(FILE *stream)
+{
+    fprintf(stream, "Usage: te [--renderer gl|grid|sdl|soft|tty] [--font bitmap|ttf] [--stats <file.csv|file.json>] [--bench] [--bench-startup] [--golden <dir>] [--golden-record <dir>] [file]\n");
+}
+
+void handle_event(const SDL_Event *event, const char *file_path, bool *quit)
+{
+    const size_t prev_row = editor.cursor_row;
+    const size_t prev_size = editor.size;
+
+    switch (event->type)
+    {
+    case SDL_QUIT:
+        *quit = true;
+        break;
+    case SDL_WINDOWEVENT:
+        // Moving to a display with another pixel density changes the
+        // drawable size, possibly without changing the window size.
+        if (event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+            event->window.event == SDL_WINDOWEVENT_DISPLAY_CHANGED)
+        {
+            view_resize(&view, SDL_GetWindowFromID(event->window.windowID));
+            if (view.pixel_scale != pixel_scale)
+            {
+                set_pixel_scale(view.pixel_scale);
+            }
+            view_fit_zoom(&view);
+        }
+        damage_all();
+        break;
+    case SDL_RENDER_TARGETS_RESET:
+    case SDL_RENDER_DEVICE_RESET:
+        row_tiles_invalidate();
+        damage_all();
+        break;
+    case SDL_KEYDOWN:
+        switch (event->key.keysym.sym)
+        {
+        case SDLK_BACKSPACE:
+            editor_backspace(&editor);
+            break;
+        case SDLK_LEFT:
+            move_cursor_left();
+            break;
+        case SDLK_RIGHT:
+            move_cursor_right();
+            break;
+        case SDLK_DELETE:
+            editor_delete(&editor);
+            break;
+        case SDLK_ESCAPE:
+            *quit = true;
+            break;
+        case SDLK_UP:
+            move_cursor_up();
+            break;
+        case SDLK_DOWN:
+            move_cursor_down();
+            break;
+        case SDLK_RETURN:
+            editor_insert_new_line(&editor);
+            break;
+        case SDLK_F3:
+            profiler.overlay = !profiler.overlay;
+            damage_all();
+            return;
+        case SDLK_0:
+            if (zoom_enabled && (SDL_GetModState() & KMOD_CTRL))
+            {
+                set_zoom(1.0f);
+            }
+            return;
+        case SDLK_F2:
+            if (file_path)
+            {
+                editor_save_to_file(&editor, file_path);
+            }
+            return;
+        default:
+            return;
+        }
+        break;
+    case SDL_TEXTINPUT:
+        editor_insert_text_before_cursor(&editor, event->text.text);
+        break;
+    case SDL_MOUSEWHEEL:
+        if (zoom_enabled && (SDL_GetModState() & KMOD_CTRL))
+        {
+            set_zoom(zoom * powf(ZOOM_STEP, (float)event->wheel.y));
+        }
+        return;
+    default:
+        return;
+    }
+
+    const size_t first = prev_row < editor.cursor_row ? prev_row : editor.cursor_row;
+    const size_t last = prev_row < editor.cursor_row ? editor.cursor_row : prev_row;
+    if (editor.size != prev_size)
+    {
+        // Lines below the edit shifted.
+        damage_rows(first, SIZE_MAX);
+    }
+    else
+    {
+        damage_rows(first, last + 1);
+    }
+}
+
+#define BENCH_LINES 20000
+#define BENCH_LONG_LINE_EVERY 97
+#define BENCH_LONG_LINE_SIZE 4000
+
+// Synthetic buffer for --bench when no file is given: lines of varying
+// length with a very long one every BENCH_LONG_LINE_EVERY lines.
+void bench_fill_editor(Editor *editor)
+{
+    static char text[BENCH_LONG_LINE_SIZE + 1];
+
+    for (size_t row = 0; row < BENCH_LINES; ++row)
+    {
+        size_t size = (row * 37) % 160;
+        if (row % BENCH_LONG_LINE_EVERY == 0)
+        {
+            size = BENCH_LONG_LINE_SIZE;
+        }
+        for (size_t col = 0; col < size; ++col)
+        {
+            text[col] = (char)(ASCII_DISPLAY_LOW + (row + col * 7) % (ASCII_DISPLAY_HIGH - ASCII_DISPLAY_LOW + 1));
+        }
+        text[size] = '\0';
+
+        editor_insert_text_before_cursor(editor, text);
+        editor_insert_new_line(editor);
+    }
+    editor->cursor_row = 0;
+    editor->cursor_col = 0;
+}
+
+typedef struct
+{
+    size_t frames;
+    SDL_Keycode key;
+    const char *text;
+} Bench_Step;
+
+// Scroll down, type, split lines, scroll right along a long line, scroll
+// back up. One event per frame.
+const Bench_Step bench_script[] = {
+    {400, SDLK_DOWN, NULL},
+    {200, SDLK_UNKNOWN, "x"},
+    {100, SDLK_RETURN, NULL},
+    {100, SDLK_BACKSPACE, NULL},
+    {300, SDLK_RIGHT, NULL},
+    {400, SDLK_UP, NULL},
+};
+
+// Returns false once the script is over.
+bool bench_script_event(size_t frame, SDL_Event *event)
+{
+    for (size_t i = 0; i < sizeof(bench_script) / sizeof(bench_script[0]); ++i)
+    {
+        const Bench_Step *step = &bench_script[i];
+        if (frame < step->frames)
+        {
+            memset(event, 0, sizeof(*event));
+            if (step->text)
+            {
+                event->type = SDL_TEXTINPUT;
+                strncpy(event->text.text, step->text, sizeof(event->text.text) - 1);
+            }
+            else
+            {
+                event->type = SDL_KEYDOWN;
+                event->key.keysym.sym = step->key;
+            }
+            return true;
+        }
+        frame -= step->frames;
+    }
+    return false;
+}
+
+// Startup runs the file load and the font preparation on worker threads
+// while the main thread brings up SDL, the window and the GL context or
+// renderer. Both are joined before the first frame.
+typedef struct
+{
+    const char *file_path;
+    bool bench;
+    bool ttf;
+    bool sdf;
+    const char *cache_dir;
+    bool font_ok;
+    Uint64 file_time;
+    Uint64 font_time;
+} Startup;
+
+int startup_load_file(void *data)
+{
+    Startup *startup = (Startup *)data;
+    const Uint64 begin = SDL_GetPerformanceCounter();
+
+    if (startup->file_path)
+    {
+        FILE *f = fopen(startup->file_path, "rb");
+        if (f != NULL)
+        {
+            editor_load_from_file(&editor, f);
+            fclose(f);
+        }
+    }
+    else if (startup->bench)
+    {
+        bench_fill_editor(&editor);
+    }
+
+    startup->file_time = SDL_GetPerformanceCounter() - begin;
+    return 0;
+}
+
+int startup_prepare_font(void *data)
+{
+    Startup *startup = (Startup *)data;
+    const Uint64 begin = SDL_GetPerformanceCounter();
+
+    if (startup->sdf)
+    {
+        startup->font_ok = sdf_atlas_load(&sdf_atlas, FONT_TTF_FILE_PATH, startup->cache_dir);
+    }
+    else if (startup->ttf)
+    {
+        startup->font_ok = font_prepare_ttf(&font, FONT_TTF_FILE_PATH, FONT_TTF_PIXEL_SIZE);
+    }
+    else
+    {
+        font_prepare_bitmap(&font);
+        startup->font_ok = true;
+    }
+
+    startup->font_time = SDL_GetPerformanceCounter() - begin;
+    return 0;
+}
+
+#define STARTUP_MARKS_CAP 16
+
+// Main thread timeline for --bench-startup, each mark ends a step.
+typedef struct
+{
+    const char *name;
+    Uint64 time;
+} Startup_Mark;
+
+Startup_Mark startup_marks[STARTUP_MARKS_CAP];
+size_t startup_marks_count = 0;
+
+void startup_mark(const char *name)
+{
+    if (startup_marks_count < STARTUP_MARKS_CAP)
+    {
+        startup_marks[startup_marks_count++] = (Startup_Mark){name, SDL_GetPerformanceCounter()};
+    }
+}
+
+void startup_report(const Startup *startup)
+{
+    const double ms = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    if (startup_marks_count == 0)
+    {
+        return;
+    }
+
+    printf("bench-startup: %.3f ms to first frame\n",
+           (double)(startup_marks[startup_marks_count - 1].time - startup_marks[0].time) * ms);
+    for (size_t i = 1; i < startup_marks_count; ++i)
+    {
+        printf("  main    %-14s %8.3f ms\n", startup_marks[i].name,
+               (double)(startup_marks[i].time - startup_marks[i - 1].time) * ms);
+    }
+    printf("  worker  %-14s %8.3f ms, %llu allocations\n", "load file", (double)startup->file_time * ms,
+           (unsigned long long)profiler_background_count(PROFILER_COUNTER_ALLOCATIONS));
+    if (startup->font_time > 0)
+    {
+        printf("  worker  %-14s %8.3f ms\n", "prepare font", (double)startup->font_time * ms);
+    }
+}
+
+// One fixed simulation step of the camera towards `target`.
+void camera_step(Vec2f target)
+{
+    const Vec2f delta = vec2f_sub(target, camera_sim.pos);
+    if (fabsf(delta.x) < 0.5f && fabsf(delta.y) < 0.5f)
+    {
+        camera_sim.pos = target;
+        camera_sim.vel = vec2fs(0.0f);
+        return;
+    }
+
+    camera_sim.vel = vec2f_mul(delta, vec2fs(SIMULATION_STEP));
+    camera_sim.pos = vec2f_add(camera_sim.pos, camera_sim.vel);
+}
+
+Vec2f camera_target(void)
+{
+    return vec2f((float)cursor_cell_col() * cell_size.x, (float)editor.cursor_row * cell_size.y);
+}
+
+// Advances the camera simulation by `elapsed` seconds of real time and
+// interpolates camera_pos. Returns false once the camera has settled on the
+// cursor, so the loop can go idle.
+bool camera_update(float elapsed)
+{
+    if (elapsed > SIMULATION_MAX_ELAPSED)
+    {
+        elapsed = SIMULATION_MAX_ELAPSED;
+    }
+
+    const Vec2f target = camera_target();
+    camera_sim.accumulator += elapsed;
+    while (camera_sim.accumulator >= SIMULATION_STEP)
+    {
+        camera_sim.prev_pos = camera_sim.pos;
+        camera_step(target);
+        camera_sim.accumulator -= SIMULATION_STEP;
+    }
+
+    const float alpha = camera_sim.accumulator / SIMULATION_STEP;
+    camera_pos = vec2f_add(camera_sim.prev_pos, vec2f_mul(vec2f_sub(camera_sim.pos, camera_sim.prev_pos), vec2fs(alpha)));
+
+    const bool settled = camera_sim.pos.x == target.x && camera_sim.pos.y == target.y &&
+                         camera_sim.prev_pos.x == target.x && camera_sim.prev_pos.y == target.y;
+    if (settled)
+    {
+        camera_sim.accumulator = 0.0f;
+    }
+    return !settled;
+}
+
+typedef struct
+{
+    const char *name;
+    size_t cursor_row;
+    size_t cursor_col;
+} Golden_Case;
+
+// Fixed editor states over the --bench buffer (or the given file). The
+// camera is snapped onto the cursor, so each case is one exact scroll offset.
+const Golden_Case golden_cases[] = {
+    {"top", 0, 0},
+    {"middle", 5000, 20},
+    {"long-line", BENCH_LONG_LINE_EVERY * 3, 300},
+    {"end", BENCH_LINES, 0},
+};
+#define GOLDEN_WARM_FRAMES 10
+
+// The frame in the back buffer (window surface for soft), before presenting.
+void golden_read_frame(Renderer_Backend backend, SDL_Window *window, SDL_Renderer *renderer, const View *view, Golden_Image *image)
+{
+    switch (backend)
+    {
+    case RENDERER_OPENGL:
+    case RENDERER_OPENGL_GRID:
+    {
+        const int w = (int)view->drawable_size.x;
+        const int h = (int)view->drawable_size.y;
+        uint8_t *rgba = (uint8_t *)scp(malloc((size_t)w * (size_t)h * 4));
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+        golden_image_from_rgba(image, rgba, w, h, w * 4, true);
+        free(rgba);
+        break;
+    }
+    case RENDERER_SDL:
+    {
+        int w, h;
+        scc(SDL_GetRendererOutputSize(renderer, &w, &h));
+        uint8_t *rgba = (uint8_t *)scp(malloc((size_t)w * (size_t)h * 4));
+        scc(SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_RGBA32, rgba, w * 4));
+        golden_image_from_rgba(image, rgba, w, h, w * 4, false);
+        free(rgba);
+        break;
+    }
+    case RENDERER_SOFTWARE:
+    {
+        SDL_Surface *surface = soft_surface != NULL ? soft_surface : (SDL_Surface *)scp(SDL_GetWindowSurface(window));
+        if (SDL_MUSTLOCK(surface))
+        {
+            scc(SDL_LockSurface(surface));
+        }
+        golden_image_from_xrgb(image, (const uint32_t *)surface->pixels, surface->w, surface->h, surface->pitch);
+        if (SDL_MUSTLOCK(surface))
+        {
+            SDL_UnlockSurface(surface);
+        }
+        break;
+    }
+    case RENDERER_TTY:
+        break;
+    }
+}
+
+// Renders every golden case with the active renderer and compares it to
+// <dir>/<renderer>-<case>.ppm. A frame that differs is saved as
+// <renderer>-<case>.actual.ppm and a missing image fails the case; images
+// are only written, over any existing ones, when `record`. Every case
+// reports the time of its first (cold) render and the average of the warm
+// ones.
+bool golden_run(Renderer_Backend backend, SDL_Window *window, SDL_Renderer *renderer, const char *dir, bool record)
+{
+    bool ok = true;
+    const double ms = 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+    for (size_t i = 0; i < sizeof(golden_cases) / sizeof(golden_cases[0]); ++i)
+    {
+        const Golden_Case *c = &golden_cases[i];
+        editor.cursor_row = 0;
+        editor.cursor_col = 0;
+        if (editor.size > 0)
+        {
+            editor.cursor_row = c->cursor_row < editor.size ? c->cursor_row : editor.size - 1;
+            const size_t line_size = editor.lines[editor.cursor_row].size;
+            editor.cursor_col = c->cursor_col < line_size ? c->cursor_col : line_size;
+        }
+
+        const Vec2f target = camera_target();
+        camera_sim = (Camera_Sim){.prev_pos = target, .pos = target};
+        camera_pos = target;
+        view_update(&view);
+
+        double cold = 0.0;
+        double warm = 0.0;
+        for (size_t frame = 0; frame <= GOLDEN_WARM_FRAMES; ++frame)
+        {
+            damage_all();
+            const Uint64 begin = SDL_GetPerformanceCounter();
+            switch (backend)
+            {
+            case RENDERER_OPENGL:
+                render_editor_gl(&tile_glyph_buffer, &view);
+                glFinish();
+                break;
+            case RENDERER_OPENGL_GRID:
+                render_editor_gl_grid(&grid_glyph, &view);
+                glFinish();
+                break;
+            case RENDERER_SDL:
+                render_editor_sdl(renderer, &view, &font);
+                SDL_RenderFlush(renderer);
+                break;
+            case RENDERER_SOFTWARE:
+            {
+                SDL_Rect rects[SOFT_BANDS_CAP];
+                render_editor_soft(window, &view, rects);
+                break;
+            }
+            case RENDERER_TTY:
+                break;
+            }
+            damage_clear();
+
+            const double duration = (double)(SDL_GetPerformanceCounter() - begin) * ms;
+            if (frame == 0)
+            {
+                cold = duration;
+            }
+            else
+            {
+                warm += duration / GOLDEN_WARM_FRAMES;
             }
         }
 
+        Golden_Image actual = {0};
+        golden_read_frame(backend, window, renderer, &view, &actual);
+
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s-%s.ppm", dir, renderer_backend_name(backend), c->name);
+        Golden_Image expected = {0};
+        const char *result = "ok";
+        errno = 0;
+        if (record)
         {
-            const Vec2f cursor_pos = vec2f((float)editor.cursor_col * FONT_CHAR_WIDTH * FONT_SCALE, (float)editor.cursor_row * FONT_CHAR_HEIGHT * FONT_SCALE);
-            camera_vel = vec2f_sub(cursor_pos, camera_pos);
-            camera_vel = vec2f_mul(camera_vel, vec2fs(DELTA_TIME));
-            camera_pos = vec2f_add(camera_pos, camera_vel);
+            if (golden_image_write(&actual, path))
+            {
+                result = "recorded";
+            }
+            else
+            {
+                result = "FAILED to record";
+                ok = false;
+            }
+        }
+        else if (golden_image_read(&expected, path))
+        {
+            const size_t diff = golden_image_diff(&expected, &actual);
+            if (diff != 0)
+            {
+                ok = false;
+                if (diff == SIZE_MAX)
+                {
+                    result = "MISMATCH (size differs)";
+                }
+                else
+                {
+                    result = "MISMATCH";
+                    printf("golden %s/%s: %zu pixels differ\n", renderer_backend_name(backend), c->name, diff);
+                }
+                snprintf(path, sizeof(path), "%s/%s-%s.actual.ppm", dir, renderer_backend_name(backend), c->name);
+                golden_image_write(&actual, path);
+            }
+            golden_image_free(&expected);
         }
+        else
+        {
+            result = errno == ENOENT ? "MISSING (record it with --golden-record)" : "FAILED to read";
+            ok = false;
+        }
+        golden_image_free(&actual);
+
+        printf("golden %s/%s: %s, render cold %.3f ms, warm %.3f ms\n",
+               renderer_backend_name(backend), c->name, result, cold, warm);
+    }
 
-        scc(SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0));
-        scc(SDL_RenderClear(renderer));
+    return ok;
+}
+
+// First row or column of a `size` cell wide window that keeps `cursor` in
+// view, moving `scroll` as little as possible.
+size_t tty_follow(size_t scroll, size_t cursor, int size)
+{
+    if (cursor < scroll)
+    {
+        return cursor;
+    }
+    if (cursor >= scroll + (size_t)size)
+    {
+        return cursor - (size_t)size + 1;
+    }
+    return scroll;
+}
 
-        for (size_t row = 0; row < editor.size; ++row)
+// Same text as the bitmap renderers: one cell per byte, bytes the font has
+// no glyph for become '?'.
+void render_editor_tty(Tty_Screen *screen, size_t scroll_row, size_t scroll_col, bool full)
+{
+    char *text = (char *)scp(malloc((size_t)screen->width));
+    for (int y = 0; y < screen->height; ++y)
+    {
+        const size_t row = scroll_row + (size_t)y;
+        if (!full && !(row >= damage.row_begin && row < damage.row_end))
+        {
+            continue;
+        }
+
+        size_t size = 0;
+        if (row < editor.size && scroll_col < editor.lines[row].size)
         {
             const Line *line = &editor.lines[row];
-            const Vec2f line_pos = camera_project_point(window, vec2f(0, (float)row * FONT_CHAR_HEIGHT * FONT_SCALE));
-            render_text_sized(renderer, &font, line->chars, line->size, line_pos, 0xffffffff, FONT_SCALE);
+            size = line->size - scroll_col;
+            size = size < (size_t)screen->width ? size : (size_t)screen->width;
+            for (size_t i = 0; i < size; ++i)
+            {
+                const char ch = line->chars[scroll_col + i];
+                text[i] = ch >= ASCII_DISPLAY_LOW && ch <= ASCII_DISPLAY_HIGH ? ch : '?';
+            }
+        }
+        tty_screen_put_row(screen, y, text, size);
+        profiler_count(PROFILER_COUNTER_GLYPHS, size);
+    }
+    free(text);
+
+    screen->cursor_x = (int)(editor.cursor_col - scroll_col);
+    screen->cursor_y = (int)(editor.cursor_row - scroll_row);
+}
+
+// Terminal frontend: no SDL video, the editor is drawn as text cells and each
+// frame sends only the cells that changed.
+int tty_main(const char *file_path, const char *stats_file_path)
+{
+    if (file_path)
+    {
+        FILE *f = fopen(file_path, "rb");
+        if (f != NULL)
+        {
+            editor_load_from_file(&editor, f);
+            fclose(f);
+        }
+    }
+
+    if (!tty_begin())
+    {
+        return 1;
+    }
+
+    Tty_Screen screen = {0};
+    size_t scroll_row = 0;
+    size_t scroll_col = 0;
+    bool resized = true;
+    bool quit = false;
+    while (!quit)
+    {
+        profiler_frame_begin();
+        if (resized)
+        {
+            int width, height;
+            tty_get_size(&width, &height);
+            tty_screen_resize(&screen, width, height);
+            damage_all();
+        }
+
+        SDL_Event event;
+        while (tty_poll_event(&event))
+        {
+            handle_event(&event, file_path, &quit);
+        }
+
+        profiler_enter(PROFILER_PHASE_UPDATE);
+        const size_t new_scroll_row = tty_follow(scroll_row, editor.cursor_row, screen.height);
+        const size_t new_scroll_col = tty_follow(scroll_col, editor.cursor_col, screen.width);
+        if (new_scroll_col != scroll_col)
+        {
+            damage_all();
+        }
+        else if (new_scroll_row != scroll_row)
+        {
+            // The terminal moves the rows that stay visible itself.
+            tty_screen_scroll(&screen, (int)(new_scroll_row - scroll_row));
+            const size_t begin = new_scroll_row > scroll_row ? scroll_row + (size_t)screen.height : new_scroll_row;
+            const size_t end = new_scroll_row > scroll_row ? new_scroll_row + (size_t)screen.height : scroll_row;
+            damage_rows(begin, end);
+        }
+        scroll_row = new_scroll_row;
+        scroll_col = new_scroll_col;
+
+        profiler_enter(PROFILER_PHASE_RENDER);
+        render_editor_tty(&screen, scroll_row, scroll_col, damage.full);
+        damage_clear();
+
+        profiler_enter(PROFILER_PHASE_PRESENT);
+        profiler_count(PROFILER_COUNTER_OUTPUT_BYTES, tty_screen_flush(&screen));
+        profiler_frame_end();
+
+        if (!quit)
+        {
+            resized = tty_wait();
+        }
+    }
+
+    tty_end();
+    tty_screen_free(&screen);
+    if (stats_file_path)
+    {
+        profiler_dump_to_file(stats_file_path);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *file_path = NULL;
+    Renderer_Backend backend = RENDERER_OPENGL;
+    bool ttf = false;
+    const char *stats_file_path = NULL;
+    bool bench = false;
+    bool bench_startup = false;
+    const char *golden_dir = NULL;
+    bool golden_record = false;
+
+    startup_mark("start");
+    profiler_init();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--renderer") == 0 && i + 1 < argc)
+        {
+            const char *name = argv[++i];
+            if (strcmp(name, "gl") == 0)
+            {
+                backend = RENDERER_OPENGL;
+            }
+            else if (strcmp(name, "grid") == 0)
+            {
+                backend = RENDERER_OPENGL_GRID;
+            }
+            else if (strcmp(name, "sdl") == 0)
+            {
+                backend = RENDERER_SDL;
+            }
+            else if (strcmp(name, "soft") == 0)
+            {
+                backend = RENDERER_SOFTWARE;
+            }
+            else if (strcmp(name, "tty") == 0)
+            {
+                backend = RENDERER_TTY;
+            }
+            else
+            {
+                fprintf(stderr, "ERROR: unknown renderer `%s`\n", name);
+                usage(stderr);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc)
+        {
+            const char *name = argv[++i];
+            if (strcmp(name, "bitmap") == 0)
+            {
+                ttf = false;
+            }
+            else if (strcmp(name, "ttf") == 0)
+            {
+                ttf = true;
+            }
+            else
+            {
+                fprintf(stderr, "ERROR: unknown font `%s`\n", name);
+                usage(stderr);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+        {
+            stats_file_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--bench") == 0)
+        {
+            bench = true;
+        }
+        else if (strcmp(argv[i], "--bench-startup") == 0)
+        {
+            bench_startup = true;
+        }
+        else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+        {
+            golden_dir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--golden-record") == 0 && i + 1 < argc)
+        {
+            golden_dir = argv[++i];
+            golden_record = true;
+        }
+        else if (strcmp(argv[i], "--help") == 0)
+        {
+            usage(stdout);
+            return 0;
+        }
+        else
+        {
+            file_path = argv[i];
+        }
+    }
+
+    if (ttf && (backend == RENDERER_OPENGL_GRID || backend == RENDERER_SOFTWARE || backend == RENDERER_TTY))
+    {
+        fprintf(stderr, "ERROR: the ttf font is not supported by the %s renderer\n", renderer_backend_name(backend));
+        exit(1);
+    }
+
+    if (backend == RENDERER_TTY)
+    {
+        if (golden_dir != NULL || bench || bench_startup)
+        {
+            fprintf(stderr, "ERROR: the tty renderer has no benchmarks or golden images\n");
+            exit(1);
+        }
+        return tty_main(file_path, stats_file_path);
+    }
+
+    // Golden runs use the bench buffer and never wait for the display.
+    if (golden_dir != NULL)
+    {
+        bench = true;
+    }
+
+    // Per user cache directory for linked shader programs and the SDF atlas.
+    char *pref_path = SDL_GetPrefPath("Lex", "te");
+
+    Startup startup = {
+        .file_path = file_path,
+        .bench = bench,
+        .ttf = ttf,
+        .sdf = ttf && backend == RENDERER_OPENGL,
+        .cache_dir = pref_path,
+    };
+    SDL_Thread *file_thread = (SDL_Thread *)scp(SDL_CreateThread(startup_load_file, "load file", &startup));
+    SDL_Thread *font_thread = NULL;
+    if (backend == RENDERER_SDL || startup.sdf)
+    {
+        font_thread = (SDL_Thread *)scp(SDL_CreateThread(startup_prepare_font, "prepare font", &startup));
+    }
+    startup_mark("spawn workers");
+
+    scc(SDL_Init(SDL_INIT_VIDEO));
+    startup_mark("sdl init");
+
+    SDL_Window *window = NULL;
+    SDL_Renderer *renderer = NULL;
+    bool vsync = false;
+
+    switch (backend)
+    {
+    case RENDERER_OPENGL:
+    case RENDERER_OPENGL_GRID:
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+
+        window = (SDL_Window *)scp(SDL_CreateWindow("Text Editor", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOW_OPENGL));
+        startup_mark("window");
+        gl_init(window);
+        startup_mark("gl context");
+        if (pref_path != NULL)
+        {
+            // Linked shader programs are cached keyed by driver and shader
+            // source, so later launches skip compiling them.
+            program_cache_set_dir(pref_path);
+        }
+        // Present at the display refresh rate, the camera moves by real
+        // time either way. The bench runs unsynchronized.
+        vsync = !bench && SDL_GL_SetSwapInterval(1) == 0;
+        if (bench)
+        {
+            SDL_GL_SetSwapInterval(0);
+        }
+
+        if (backend == RENDERER_OPENGL_GRID)
+        {
+            if (!grid_glyph_init(&grid_glyph, "./shaders/grid.vert", "./shaders/grid.frag"))
+            {
+                exit(1);
+            }
+        }
+        else if (startup.sdf)
+        {
+            SDL_WaitThread(font_thread, NULL);
+            startup_mark("join font");
+            if (!startup.font_ok ||
+                !tile_glyph_buffer_init_sdf(&tile_glyph_buffer, &sdf_atlas, "./shaders/font.vert", "./shaders/font_sdf.frag"))
+            {
+                exit(1);
+            }
+        }
+        else if (!tile_glyph_buffer_init(&tile_glyph_buffer, "./shaders/font.vert", "./shaders/font.frag"))
+        {
+            exit(1);
+        }
+        // Instances are placed by the glyph size uniform, so zooming costs
+        // nothing more than a redraw.
+        zoom_enabled = backend == RENDERER_OPENGL;
+        if (backend == RENDERER_OPENGL)
+        {
+            // The main thread takes render jobs as well.
+            const int cpus = SDL_GetCPUCount();
+            job_pool_init(&render_pool, cpus > 1 ? (size_t)cpus - 1 : 0);
+        }
+        startup_mark("gl programs");
+        break;
+
+    case RENDERER_SDL:
+        window = (SDL_Window *)scp(SDL_CreateWindow("Text Editor", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI));
+        startup_mark("window");
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE | (bench ? 0 : SDL_RENDERER_PRESENTVSYNC));
+        if (renderer == NULL)
+        {
+            // Headless video drivers (dummy, offscreen without EGL) only
+            // offer the software renderer.
+            fprintf(stderr, "WARNING: no accelerated renderer: %s, falling back to software\n", SDL_GetError());
+            renderer = (SDL_Renderer *)scp(SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE | SDL_RENDERER_TARGETTEXTURE));
+        }
+        {
+            SDL_RendererInfo info;
+            vsync = SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC);
+        }
+        glyph_batch_init(&glyph_batch, renderer);
+        startup_mark("renderer");
+
+        SDL_WaitThread(font_thread, NULL);
+        startup_mark("join font");
+        if (!startup.font_ok)
+        {
+            exit(1);
+        }
+        if (ttf)
+        {
+            font_upload_ttf(renderer, &font);
+        }
+        else
+        {
+            font_upload_bitmap(renderer, &font);
+        }
+        startup_mark("font upload");
+        break;
+
+    case RENDERER_SOFTWARE:
+        window = (SDL_Window *)scp(SDL_CreateWindow("Text Editor", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI));
+        startup_mark("window");
+        soft_atlas_get(FONT_SCALE);
+        startup_mark("glyph atlas");
+        break;
+
+    case RENDERER_TTY:
+        // Runs in tty_main, SDL video is never initialized.
+        break;
+    }
+
+    SDL_WaitThread(file_thread, NULL);
+    startup_mark("join file");
+    SDL_free(pref_path);
+    view_resize(&view, window);
+    set_pixel_scale(view.pixel_scale);
+    view_fit_zoom(&view);
+
+    if (golden_dir != NULL)
+    {
+        const bool ok = golden_run(backend, window, renderer, golden_dir, golden_record);
+        job_pool_free(&render_pool);
+        SDL_Quit();
+        return ok ? 0 : 1;
+    }
+
+    bool quit = false;
+    bool camera_moving = true;
+    Vec2f drawn_camera = camera_pos;
+    Uint64 sim_time = SDL_GetPerformanceCounter();
+    size_t bench_frame = 0;
+    const Uint64 bench_start = SDL_GetPerformanceCounter();
+    const double bench_cpu_start = profiler_process_cpu_seconds();
+    while (!quit)
+    {
+        SDL_Event event = {0};
+        bool has_event = false;
+        const bool idle = !bench && !damage.dirty && !camera_moving;
+        if (idle)
+        {
+            has_event = SDL_WaitEventTimeout(&event, IDLE_TIMEOUT_MS);
+        }
+
+        // The frame starts after the idle wait, so the event that ended the
+        // wait is handled as part of it.
+        const Uint32 start = SDL_GetTicks();
+        profiler_frame_begin();
+        if (bench)
+        {
+            has_event = bench_script_event(bench_frame++, &event);
+            quit = !has_event;
+        }
+        if (has_event)
+        {
+            handle_event(&event, file_path, &quit);
+        }
+        if (idle)
+        {
+            // Time spent idle is not simulated.
+            sim_time = SDL_GetPerformanceCounter();
+        }
+        while (SDL_PollEvent(&event))
+        {
+            handle_event(&event, file_path, &quit);
+        }
+
+        profiler_enter(PROFILER_PHASE_UPDATE);
+        const Uint64 now = SDL_GetPerformanceCounter();
+        // The bench advances one step per frame so its runs are reproducible.
+        const float elapsed = bench ? SIMULATION_STEP : (float)(now - sim_time) / (float)SDL_GetPerformanceFrequency();
+        sim_time = now;
+        camera_moving = camera_update(elapsed);
+        // The step that settles the camera still moves it, so compare with
+        // the camera of the last drawn frame as well.
+        if (camera_moving || camera_pos.x != drawn_camera.x || camera_pos.y != drawn_camera.y)
+        {
+            damage_all();
         }
-        render_cursor(renderer, window, &font);
 
-        SDL_RenderPresent(renderer);
+        if (!damage.dirty)
+        {
+            continue;
+        }
+
+        profiler_enter(PROFILER_PHASE_RENDER);
+        view_update(&view);
+        switch (backend)
+        {
+        case RENDERER_OPENGL:
+            render_editor_gl(&tile_glyph_buffer, &view);
+            profiler_enter(PROFILER_PHASE_PRESENT);
+            SDL_GL_SwapWindow(window);
+            break;
+        case RENDERER_OPENGL_GRID:
+            render_editor_gl_grid(&grid_glyph, &view);
+            profiler_enter(PROFILER_PHASE_PRESENT);
+            SDL_GL_SwapWindow(window);
+            break;
+        case RENDERER_SDL:
+            render_editor_sdl(renderer, &view, &font);
+            profiler_enter(PROFILER_PHASE_PRESENT);
+            SDL_RenderPresent(renderer);
+            break;
+        case RENDERER_SOFTWARE:
+        {
+            SDL_Rect rects[SOFT_BANDS_CAP];
+            const int count = render_editor_soft(window, &view, rects);
+            profiler_enter(PROFILER_PHASE_PRESENT);
+            scc(SDL_UpdateWindowSurfaceRects(window, rects, count));
+            break;
+        }
+        case RENDERER_TTY:
+            break;
+        }
+        damage_clear();
+        drawn_camera = camera_pos;
+        profiler_frame_end();
+
+        if (bench_startup)
+        {
+            startup_mark("first frame");
+            startup_report(&startup);
+            quit = true;
+        }
 
         const Uint32 duration = SDL_GetTicks() - start;
         const Uint32 delta_time_ms = 1000 / FPS;
-        if (duration < delta_time_ms)
+        if (!bench && !vsync && duration < delta_time_ms)
         {
             SDL_Delay(delta_time_ms - duration);
         }
     }
 
+    if (bench)
+    {
+        const double wall = (double)(SDL_GetPerformanceCounter() - bench_start) / (double)SDL_GetPerformanceFrequency();
+        const double cpu = profiler_process_cpu_seconds() - bench_cpu_start;
+        const double frames = (double)profiler.frame_count;
+        double p50, p99;
+        profiler_frame_percentiles(&p50, &p99);
+        printf("bench-render %s: %zu frames in %.3fs, %.1f fps, process cpu %.3f ms/frame, frame p50 %.3f ms p99 %.3f ms\n",
+               renderer_backend_name(backend), profiler.frame_count, wall,
+               frames > 0 ? frames / wall : 0.0,
+               frames > 0 ? cpu * 1000.0 / frames : 0.0,
+               p50, p99);
+    }
+
+    if (stats_file_path)
+    {
+        profiler_dump_to_file(stats_file_path);
+    }
+
+    job_pool_free(&render_pool);
     SDL_Quit();
 
     return 0;
 }
-#endif
\ No newline at end of file
@@ -0,0 +1,281 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <SDL2/SDL.h>
+
+#include "profiler.h"
+
+Profiler profiler = {0};
+
+static double profiler_ms(uint64_t ticks)
+{
+    return (double)ticks * 1000.0 / (double)profiler.frequency;
+}
+
+void profiler_init(void)
+{
+    profiler.thread = SDL_ThreadID();
+    profiler.frequency = SDL_GetPerformanceFrequency();
+}
+
+void profiler_frame_begin(void)
+{
+    if (profiler.frequency == 0)
+    {
+        profiler.frequency = SDL_GetPerformanceFrequency();
+    }
+
+    memset(&profiler.current, 0, sizeof(profiler.current));
+    profiler.frame_start = SDL_GetPerformanceCounter();
+    profiler.phase_start = profiler.frame_start;
+    profiler.phase = PROFILER_PHASE_EVENT;
+}
+
+Profiler_Phase profiler_enter(Profiler_Phase phase)
+{
+    const Profiler_Phase prev = profiler.phase;
+    if (phase != prev)
+    {
+        const uint64_t now = SDL_GetPerformanceCounter();
+        profiler.current.phase_ms[prev] += profiler_ms(now - profiler.phase_start);
+        profiler.phase_start = now;
+        profiler.phase = phase;
+    }
+    return prev;
+}
+
+void profiler_count(Profiler_Counter counter, uint64_t amount)
+{
+    if (SDL_ThreadID() != profiler.thread)
+    {
+        for (; amount > INT_MAX; amount -= INT_MAX)
+        {
+            SDL_AtomicAdd(&profiler.background[counter], INT_MAX);
+        }
+        SDL_AtomicAdd(&profiler.background[counter], (int)amount);
+        return;
+    }
+    profiler.current.counters[counter] += amount;
+}
+
+void profiler_frame_end(void)
+{
+    const uint64_t now = SDL_GetPerformanceCounter();
+    profiler.current.phase_ms[profiler.phase] += profiler_ms(now - profiler.phase_start);
+    profiler.current.frame_ms = profiler_ms(now - profiler.frame_start);
+
+    profiler.history[profiler.frame_count % PROFILER_HISTORY_CAP] = profiler.current;
+    profiler.frame_count += 1;
+}
+
+uint64_t profiler_background_count(Profiler_Counter counter)
+{
+    return (uint32_t)SDL_AtomicGet(&profiler.background[counter]);
+}
+
+double profiler_process_cpu_seconds(void)
+{
+#ifdef _WIN32
+    FILETIME creation, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exited, &kernel, &user))
+    {
+        return 0.0;
+    }
+    const uint64_t kernel_ticks = (uint64_t)kernel.dwHighDateTime << 32 | kernel.dwLowDateTime;
+    const uint64_t user_ticks = (uint64_t)user.dwHighDateTime << 32 | user.dwLowDateTime;
+    // FILETIME counts 100 ns intervals.
+    return (double)(kernel_ticks + user_ticks) * 1e-7;
+#else
+    struct timespec ts;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0)
+    {
+        return 0.0;
+    }
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+const Profiler_Frame *profiler_last_frame(void)
+{
+    if (profiler.frame_count == 0)
+    {
+        return NULL;
+    }
+    return &profiler.history[(profiler.frame_count - 1) % PROFILER_HISTORY_CAP];
+}
+
+static size_t profiler_history_size(void)
+{
+    return profiler.frame_count < PROFILER_HISTORY_CAP ? profiler.frame_count : PROFILER_HISTORY_CAP;
+}
+
+// Oldest first.
+static const Profiler_Frame *profiler_history_at(size_t i)
+{
+    const size_t first = profiler.frame_count - profiler_history_size();
+    return &profiler.history[(first + i) % PROFILER_HISTORY_CAP];
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentiles of the frame times in the history ring.
+void profiler_frame_percentiles(double *p50, double *p99)
+{
+    static double sorted[PROFILER_HISTORY_CAP];
+
+    const size_t n = profiler_history_size();
+    if (n == 0)
+    {
+        *p50 = 0.0;
+        *p99 = 0.0;
+        return;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        sorted[i] = profiler_history_at(i)->frame_ms;
+    }
+    qsort(sorted, n, sizeof(sorted[0]), compare_double);
+
+    *p50 = sorted[(n * 50 + 99) / 100 - 1];
+    *p99 = sorted[(n * 99 + 99) / 100 - 1];
+}
+
+const char *profiler_phase_name(Profiler_Phase phase)
+{
+    switch (phase)
+    {
+    case PROFILER_PHASE_EVENT:
+        return "event";
+    case PROFILER_PHASE_UPDATE:
+        return "update";
+    case PROFILER_PHASE_RENDER:
+        return "render";
+    case PROFILER_PHASE_SUBMIT:
+        return "submit";
+    case PROFILER_PHASE_PRESENT:
+        return "present";
+    default:
+        return "unknown";
+    }
+}
+
+const char *profiler_counter_name(Profiler_Counter counter)
+{
+    switch (counter)
+    {
+    case PROFILER_COUNTER_DRAW_CALLS:
+        return "draw_calls";
+    case PROFILER_COUNTER_GLYPHS:
+        return "glyphs";
+    case PROFILER_COUNTER_ALLOCATIONS:
+        return "allocations";
+    case PROFILER_COUNTER_OUTPUT_BYTES:
+        return "output_bytes";
+    default:
+        return "unknown";
+    }
+}
+
+static void profiler_dump_csv(FILE *f)
+{
+    fprintf(f, "frame,frame_ms");
+    for (int phase = 0; phase < COUNT_PROFILER_PHASES; ++phase)
+    {
+        fprintf(f, ",%s_ms", profiler_phase_name((Profiler_Phase)phase));
+    }
+    for (int counter = 0; counter < COUNT_PROFILER_COUNTERS; ++counter)
+    {
+        fprintf(f, ",%s", profiler_counter_name((Profiler_Counter)counter));
+    }
+    fprintf(f, "\n");
+
+    const size_t first = profiler.frame_count - profiler_history_size();
+    for (size_t i = 0; i < profiler_history_size(); ++i)
+    {
+        const Profiler_Frame *frame = profiler_history_at(i);
+        fprintf(f, "%zu,%.4f", first + i, frame->frame_ms);
+        for (int phase = 0; phase < COUNT_PROFILER_PHASES; ++phase)
+        {
+            fprintf(f, ",%.4f", frame->phase_ms[phase]);
+        }
+        for (int counter = 0; counter < COUNT_PROFILER_COUNTERS; ++counter)
+        {
+            fprintf(f, ",%llu", (unsigned long long)frame->counters[counter]);
+        }
+        fprintf(f, "\n");
+    }
+}
+
+static void profiler_dump_json(FILE *f)
+{
+    double p50, p99;
+    profiler_frame_percentiles(&p50, &p99);
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"frames\": %zu,\n", profiler.frame_count);
+    fprintf(f, "  \"frame_ms_p50\": %.4f,\n", p50);
+    fprintf(f, "  \"frame_ms_p99\": %.4f,\n", p99);
+    fprintf(f, "  \"history\": [");
+
+    const size_t first = profiler.frame_count - profiler_history_size();
+    for (size_t i = 0; i < profiler_history_size(); ++i)
+    {
+        const Profiler_Frame *frame = profiler_history_at(i);
+        fprintf(f, "%s\n    {\"frame\": %zu, \"frame_ms\": %.4f", i > 0 ? "," : "", first + i, frame->frame_ms);
+        for (int phase = 0; phase < COUNT_PROFILER_PHASES; ++phase)
+        {
+            fprintf(f, ", \"%s_ms\": %.4f", profiler_phase_name((Profiler_Phase)phase), frame->phase_ms[phase]);
+        }
+        for (int counter = 0; counter < COUNT_PROFILER_COUNTERS; ++counter)
+        {
+            fprintf(f, ", \"%s\": %llu", profiler_counter_name((Profiler_Counter)counter), (unsigned long long)frame->counters[counter]);
+        }
+        fprintf(f, "}");
+    }
+
+    fprintf(f, "\n  ]\n}\n");
+}
+
+bool profiler_dump_to_file(const char *file_path)
+{
+    FILE *f = fopen(file_path, "wb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: could not open file %s : %s\n", file_path, strerror(errno));
+        return false;
+    }
+
+    const size_t n = strlen(file_path);
+    if (n >= 5 && strcmp(file_path + n - 5, ".json") == 0)
+    {
+        profiler_dump_json(f);
+    }
+    else
+    {
+        profiler_dump_csv(f);
+    }
+
+    const bool ok = !ferror(f);
+    if (!ok)
+    {
+        fprintf(stderr, "ERROR: could not write file %s : %s\n", file_path, strerror(errno));
+    }
+    fclose(f);
+    return ok;
+}
@@ -0,0 +1,86 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+// Per-frame timings of the main loop phases. Time is accumulated into the
+// phase that is current, so a phase can be entered several times per frame
+// (e.g. every batch flush is SUBMIT time inside the render build).
+typedef enum
+{
+    PROFILER_PHASE_EVENT = 0,
+    PROFILER_PHASE_UPDATE,
+    PROFILER_PHASE_RENDER,
+    PROFILER_PHASE_SUBMIT,
+    PROFILER_PHASE_PRESENT,
+    COUNT_PROFILER_PHASES,
+} Profiler_Phase;
+
+typedef enum
+{
+    PROFILER_COUNTER_DRAW_CALLS = 0,
+    PROFILER_COUNTER_GLYPHS,
+    PROFILER_COUNTER_ALLOCATIONS,
+    PROFILER_COUNTER_OUTPUT_BYTES,
+    COUNT_PROFILER_COUNTERS,
+} Profiler_Counter;
+
+typedef struct
+{
+    double frame_ms;
+    double phase_ms[COUNT_PROFILER_PHASES];
+    uint64_t counters[COUNT_PROFILER_COUNTERS];
+} Profiler_Frame;
+
+#define PROFILER_HISTORY_CAP 1024
+
+typedef struct
+{
+    bool overlay;
+
+    // The thread that runs the frames. Counts from other threads (e.g. the
+    // startup file load) are not part of any frame, they add up in
+    // `background` instead. The totals are 32 bit and wrap past 2^32.
+    SDL_threadID thread;
+    SDL_atomic_t background[COUNT_PROFILER_COUNTERS];
+
+    uint64_t frequency;
+    uint64_t frame_start;
+    uint64_t phase_start;
+    Profiler_Phase phase;
+    Profiler_Frame current;
+
+    // Ring of the last PROFILER_HISTORY_CAP presented frames, frame_count
+    // keeps counting past it.
+    size_t frame_count;
+    Profiler_Frame history[PROFILER_HISTORY_CAP];
+} Profiler;
+
+extern Profiler profiler;
+
+// Call on the thread that runs the frames before any other thread counts.
+void profiler_init(void);
+void profiler_frame_begin(void);
+Profiler_Phase profiler_enter(Profiler_Phase phase);
+void profiler_count(Profiler_Counter counter, uint64_t amount);
+void profiler_frame_end(void);
+
+const Profiler_Frame *profiler_last_frame(void);
+void profiler_frame_percentiles(double *p50, double *p99);
+
+// Total counted off the frame thread so far.
+uint64_t profiler_background_count(Profiler_Counter counter);
+
+// CPU time used by all threads of the process so far, in seconds.
+double profiler_process_cpu_seconds(void);
+
+const char *profiler_phase_name(Profiler_Phase phase);
+const char *profiler_counter_name(Profiler_Counter counter);
+
+// Writes the history as JSON when the path ends with `.json`, CSV otherwise.
+bool profiler_dump_to_file(const char *file_path);
+
+#endif
@@ -0,0 +1,273 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_MODULE_H
+
+#include "font.h"
+#include "sdf_atlas.h"
+#include "file.h"
+
+static void sdf_atlas_blit_glyph(Sdf_Atlas *atlas, size_t index, int ascender, const FT_GlyphSlot slot)
+{
+    const FT_Bitmap *bitmap = &slot->bitmap;
+    const int cell_x = (int)(index % (size_t)atlas->cols) * (atlas->cell_width + 2 * SDF_ATLAS_PADDING) + SDF_ATLAS_PADDING;
+    const int cell_y = (int)(index / (size_t)atlas->cols) * (atlas->cell_height + 2 * SDF_ATLAS_PADDING) + SDF_ATLAS_PADDING;
+
+    // The field reaches SDF_ATLAS_SPREAD pixels past the outline, whatever
+    // falls outside of the glyph's own cell is dropped.
+    for (int y = 0; y < (int)bitmap->rows; ++y)
+    {
+        const int cy = ascender - slot->bitmap_top + y;
+        if (cy < 0 || cy >= atlas->cell_height)
+        {
+            continue;
+        }
+        for (int x = 0; x < (int)bitmap->width; ++x)
+        {
+            const int cx = slot->bitmap_left + x;
+            if (cx < 0 || cx >= atlas->cell_width)
+            {
+                continue;
+            }
+            atlas->pixels[(size_t)(cell_y + cy) * (size_t)atlas->width + (size_t)(cell_x + cx)] =
+                bitmap->buffer[(size_t)y * (size_t)bitmap->pitch + (size_t)x];
+        }
+    }
+}
+
+// Fills the gutter of every cell with its nearest edge texel, the same
+// values GL_CLAMP_TO_EDGE would give for a texture of just that cell.
+static void sdf_atlas_pad_cells(Sdf_Atlas *atlas)
+{
+    const int pitch_x = atlas->cell_width + 2 * SDF_ATLAS_PADDING;
+    const int pitch_y = atlas->cell_height + 2 * SDF_ATLAS_PADDING;
+    for (int y = 0; y < atlas->height; ++y)
+    {
+        const int cy = y % pitch_y - SDF_ATLAS_PADDING;
+        const int sy = y - cy + (cy < 0 ? 0 : cy >= atlas->cell_height ? atlas->cell_height - 1 : cy);
+        for (int x = 0; x < atlas->width; ++x)
+        {
+            const int cx = x % pitch_x - SDF_ATLAS_PADDING;
+            const int sx = x - cx + (cx < 0 ? 0 : cx >= atlas->cell_width ? atlas->cell_width - 1 : cx);
+            atlas->pixels[(size_t)y * (size_t)atlas->width + (size_t)x] =
+                atlas->pixels[(size_t)sy * (size_t)atlas->width + (size_t)sx];
+        }
+    }
+}
+
+static bool sdf_atlas_render(Sdf_Atlas *atlas, const uint8_t *font_data, size_t font_size, const char *font_file_path)
+{
+    FT_Library library;
+    FT_Error error = FT_Init_FreeType(&library);
+    if (error)
+    {
+        fprintf(stderr, "ERROR: could not initialize FreeType: %d\n", error);
+        return false;
+    }
+
+    FT_Face face;
+    error = FT_New_Memory_Face(library, font_data, (FT_Long)font_size, 0, &face);
+    if (error)
+    {
+        fprintf(stderr, "ERROR: could not load font file %s: %d\n", font_file_path, error);
+        FT_Done_FreeType(library);
+        return false;
+    }
+
+    FT_Int spread = SDF_ATLAS_SPREAD;
+    FT_Property_Set(library, "bsdf", "spread", &spread);
+    FT_Set_Pixel_Sizes(face, 0, SDF_ATLAS_PIXEL_SIZE);
+
+    // Same cell metrics as glyph_atlas_cell_size, at the atlas size.
+    const FT_Size_Metrics *metrics = &face->size->metrics;
+    const int ascender = (int)(metrics->ascender >> 6);
+    atlas->cell_height = (int)(metrics->height >> 6);
+    atlas->cell_width = (int)(metrics->max_advance >> 6);
+    if (FT_Load_Char(face, 'M', FT_LOAD_DEFAULT) == 0)
+    {
+        atlas->cell_width = (int)(face->glyph->advance.x >> 6);
+    }
+
+    atlas->cols = SDF_ATLAS_COLS;
+    atlas->rows = (FONT_GLYPH_COUNT + SDF_ATLAS_COLS - 1) / SDF_ATLAS_COLS;
+    atlas->width = atlas->cols * (atlas->cell_width + 2 * SDF_ATLAS_PADDING);
+    atlas->height = atlas->rows * (atlas->cell_height + 2 * SDF_ATLAS_PADDING);
+    atlas->pixels = (uint8_t *)calloc((size_t)atlas->width * (size_t)atlas->height, 1);
+    assert(atlas->pixels != NULL);
+
+    // Glyphs are rasterized to coverage first and the field is computed from
+    // that bitmap (FreeType's bsdf renderer), which is several times faster
+    // than computing it from the outlines.
+    for (size_t index = 0; index < FONT_GLYPH_COUNT; ++index)
+    {
+        const FT_ULong codepoint = ASCII_DISPLAY_LOW + index;
+        if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER) != 0)
+        {
+            continue;
+        }
+        if (FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF) != 0)
+        {
+            continue;
+        }
+        sdf_atlas_blit_glyph(atlas, index, ascender, face->glyph);
+    }
+    sdf_atlas_pad_cells(atlas);
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+    return true;
+}
+
+#define SDF_ATLAS_CACHE_MAGIC 0x32464453 // "SDF2"
+
+typedef struct
+{
+    uint32_t magic;
+    int32_t cell_width;
+    int32_t cell_height;
+    int32_t cols;
+    int32_t rows;
+    int32_t width;
+    int32_t height;
+} Sdf_Atlas_Cache_Header;
+
+// The key covers the font bytes, the atlas parameters and the FreeType
+// version, anything that changes the generated field.
+static void sdf_atlas_cache_path(const uint8_t *font_data, size_t font_size, const char *cache_dir, char *path, size_t path_size)
+{
+    FT_Int major = 0, minor = 0, patch = 0;
+    FT_Library library;
+    if (FT_Init_FreeType(&library) == 0)
+    {
+        FT_Library_Version(library, &major, &minor, &patch);
+        FT_Done_FreeType(library);
+    }
+
+    const uint32_t params[] = {
+        SDF_ATLAS_PIXEL_SIZE, SDF_ATLAS_SPREAD, SDF_ATLAS_COLS, SDF_ATLAS_PADDING,
+        (uint32_t)major, (uint32_t)minor, (uint32_t)patch,
+    };
+
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < sizeof(params); ++i)
+    {
+        hash = (hash ^ ((const uint8_t *)params)[i]) * 1099511628211ULL;
+    }
+    for (size_t i = 0; i < font_size; ++i)
+    {
+        hash = (hash ^ font_data[i]) * 1099511628211ULL;
+    }
+
+    snprintf(path, path_size, "%ssdf-%016llx.bin", cache_dir, (unsigned long long)hash);
+}
+
+// A missing or malformed file is a cache miss, not an error.
+static bool sdf_atlas_cache_read(Sdf_Atlas *atlas, const char *path)
+{
+    size_t size = 0;
+    char *data = slurp_file_into_malloced_buffer(path, &size);
+    if (data == NULL)
+    {
+        errno = 0;
+        return false;
+    }
+
+    Sdf_Atlas_Cache_Header header;
+    bool ok = size >= sizeof(header);
+    if (ok)
+    {
+        memcpy(&header, data, sizeof(header));
+        ok = header.magic == SDF_ATLAS_CACHE_MAGIC &&
+             header.cols == SDF_ATLAS_COLS &&
+             header.cell_width > 0 && header.cell_height > 0 &&
+             header.rows * header.cols >= FONT_GLYPH_COUNT &&
+             header.width == header.cols * (header.cell_width + 2 * SDF_ATLAS_PADDING) &&
+             header.height == header.rows * (header.cell_height + 2 * SDF_ATLAS_PADDING) &&
+             size == sizeof(header) + (size_t)header.width * (size_t)header.height;
+    }
+    if (ok)
+    {
+        atlas->cell_width = header.cell_width;
+        atlas->cell_height = header.cell_height;
+        atlas->cols = header.cols;
+        atlas->rows = header.rows;
+        atlas->width = header.width;
+        atlas->height = header.height;
+        atlas->pixels = (uint8_t *)malloc((size_t)atlas->width * (size_t)atlas->height);
+        assert(atlas->pixels != NULL);
+        memcpy(atlas->pixels, data + sizeof(header), (size_t)atlas->width * (size_t)atlas->height);
+    }
+
+    free(data);
+    return ok;
+}
+
+static void sdf_atlas_cache_write(const Sdf_Atlas *atlas, const char *path)
+{
+    const Sdf_Atlas_Cache_Header header = {
+        .magic = SDF_ATLAS_CACHE_MAGIC,
+        .cell_width = atlas->cell_width,
+        .cell_height = atlas->cell_height,
+        .cols = atlas->cols,
+        .rows = atlas->rows,
+        .width = atlas->width,
+        .height = atlas->height,
+    };
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "WARNING: could not cache SDF atlas %s: %s\n", path, strerror(errno));
+        errno = 0;
+        return;
+    }
+
+    if (fwrite(&header, sizeof(header), 1, f) != 1 ||
+        fwrite(atlas->pixels, (size_t)atlas->width * (size_t)atlas->height, 1, f) != 1)
+    {
+        fprintf(stderr, "WARNING: could not cache SDF atlas %s: %s\n", path, strerror(errno));
+        errno = 0;
+        fclose(f);
+        remove(path);
+        return;
+    }
+    fclose(f);
+}
+
+bool sdf_atlas_load(Sdf_Atlas *atlas, const char *font_file_path, const char *cache_dir)
+{
+    memset(atlas, 0, sizeof(*atlas));
+
+    size_t font_size = 0;
+    uint8_t *font_data = (uint8_t *)slurp_file_into_malloced_buffer(font_file_path, &font_size);
+    if (font_data == NULL)
+    {
+        fprintf(stderr, "ERROR: could not load font file %s: %s\n", font_file_path, strerror(errno));
+        errno = 0;
+        return false;
+    }
+
+    char cache_path[1024 + 64];
+    if (cache_dir != NULL)
+    {
+        sdf_atlas_cache_path(font_data, font_size, cache_dir, cache_path, sizeof(cache_path));
+        if (sdf_atlas_cache_read(atlas, cache_path))
+        {
+            free(font_data);
+            return true;
+        }
+    }
+
+    const bool ok = sdf_atlas_render(atlas, font_data, font_size, font_file_path);
+    if (ok && cache_dir != NULL)
+    {
+        sdf_atlas_cache_write(atlas, cache_path);
+    }
+
+    free(font_data);
+    return ok;
+}
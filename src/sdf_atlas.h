@@ -0,0 +1,41 @@
+#ifndef SDF_ATLAS_H_
+#define SDF_ATLAS_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Pixel size the distance field is rendered at. Every on-screen size is
+// drawn from this one texture, so zooming never regenerates or re-uploads it.
+#define SDF_ATLAS_PIXEL_SIZE 48
+// Distance in atlas pixels covered by the 8 bit range on each side of the
+// outline.
+#define SDF_ATLAS_SPREAD 8
+#define SDF_ATLAS_COLS 16
+// Texels around every cell that repeat its edge, so linear filtering at the
+// cell border never blends in the neighbouring glyph's field.
+#define SDF_ATLAS_PADDING 1
+
+// Signed distance fields of the printable ASCII range of a monospaced
+// TrueType font, one cell per glyph in a fixed grid. The layout matches the
+// bitmap spritesheet (ASCII_DISPLAY_LOW first, row-major) apart from the
+// SDF_ATLAS_PADDING gutter, so the grid pitch is the cell size plus twice
+// the padding. A texel of 128 lies on the outline, larger values are
+// inside.
+typedef struct
+{
+    int cell_width;
+    int cell_height;
+    int cols;
+    int rows;
+    int width;
+    int height;
+    uint8_t *pixels;
+} Sdf_Atlas;
+
+// Generating the field takes a while, so the result is cached in
+// `cache_dir` (with trailing separator, NULL disables the cache) and later
+// loads only read it back.
+bool sdf_atlas_load(Sdf_Atlas *atlas, const char *font_file_path, const char *cache_dir);
+
+#endif
@@ -0,0 +1,173 @@
+#include <assert.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "font.h"
+#include "soft_render.h"
+#include "profiler.h"
+
+void soft_glyph_atlas_init(Soft_Glyph_Atlas *atlas, int scale)
+{
+    atlas->glyph_width = FONT_CHAR_WIDTH * scale;
+    atlas->glyph_height = FONT_CHAR_HEIGHT * scale;
+
+    const size_t glyph_size = (size_t)atlas->glyph_width * (size_t)atlas->glyph_height;
+    atlas->coverage = (uint8_t *)calloc(FONT_GLYPH_COUNT * glyph_size, 1);
+    assert(atlas->coverage != NULL);
+
+    for (size_t i = 0; i < FONT_GLYPH_COUNT; ++i)
+    {
+        const Font_Glyph_Rect *rect = &font_glyph_table[i];
+        uint8_t *glyph = &atlas->coverage[i * glyph_size];
+        for (int y = 0; y < atlas->glyph_height && y / scale < rect->h; ++y)
+        {
+            for (int x = 0; x < atlas->glyph_width && x / scale < rect->w; ++x)
+            {
+                glyph[y * atlas->glyph_width + x] = font_charmap[(rect->y + y / scale) * FONT_WIDTH + rect->x + x / scale];
+            }
+        }
+    }
+}
+
+void soft_framebuffer_clip(Soft_Framebuffer *fb, int top, int bottom)
+{
+    fb->clip_top = top < 0 ? 0 : top;
+    fb->clip_bottom = bottom > fb->height ? fb->height : bottom;
+}
+
+// 0xAABBGGRR to the framebuffer's 0xAARRGGBB.
+static uint32_t soft_color(uint32_t color)
+{
+    return (color & 0xff00ff00) | ((color & 0xff) << 16) | ((color >> 16) & 0xff);
+}
+
+// Exact x / 255 for x in [0, 255 * 255].
+static unsigned int soft_div255(unsigned int x)
+{
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+#ifdef __SSE2__
+static __m128i soft_div255_epi16(__m128i x)
+{
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+#endif
+
+// Blends `color` (framebuffer layout) over `count` pixels, weighted by one
+// coverage byte per pixel. The SSE2 path does 4 pixels at a time with the
+// same integer math as the scalar one, so both give identical pixels.
+static void soft_blend_span(uint32_t *dst, const uint8_t *coverage, int count, uint32_t color)
+{
+    const unsigned int alpha = color >> 24;
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i alpha16 = _mm_set1_epi16((short)alpha);
+    const __m128i fg16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero);
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32_t coverage4;
+        memcpy(&coverage4, coverage + i, sizeof(coverage4));
+        if (coverage4 == 0)
+        {
+            continue;
+        }
+
+        // Per pixel alpha, then spread over the 4 channels of each pixel.
+        __m128i a = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)coverage4), zero);
+        a = soft_div255_epi16(_mm_mullo_epi16(a, alpha16));
+        a = _mm_unpacklo_epi16(a, a);
+        const __m128i a_lo = _mm_unpacklo_epi32(a, a);
+        const __m128i a_hi = _mm_unpackhi_epi32(a, a);
+
+        const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        const __m128i d_lo = _mm_unpacklo_epi8(d, zero);
+        const __m128i d_hi = _mm_unpackhi_epi8(d, zero);
+        const __m128i lo = soft_div255_epi16(_mm_add_epi16(_mm_mullo_epi16(fg16, a_lo),
+                                                           _mm_mullo_epi16(d_lo, _mm_sub_epi16(full, a_lo))));
+        const __m128i hi = soft_div255_epi16(_mm_add_epi16(_mm_mullo_epi16(fg16, a_hi),
+                                                           _mm_mullo_epi16(d_hi, _mm_sub_epi16(full, a_hi))));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        if (coverage[i] == 0)
+        {
+            continue;
+        }
+        const unsigned int a = soft_div255(coverage[i] * alpha);
+        uint32_t out = 0;
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            const unsigned int fg = (color >> shift) & 0xff;
+            const unsigned int bg = (dst[i] >> shift) & 0xff;
+            out |= (uint32_t)soft_div255(fg * a + bg * (255 - a)) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+void soft_fill_rect(Soft_Framebuffer *fb, int x, int y, int w, int h, uint32_t color)
+{
+    const int x0 = x < 0 ? 0 : x;
+    const int x1 = x + w > fb->width ? fb->width : x + w;
+    const int y0 = y < fb->clip_top ? fb->clip_top : y;
+    const int y1 = y + h > fb->clip_bottom ? fb->clip_bottom : y + h;
+    const uint32_t pixel = soft_color(color);
+
+    for (int row = y0; row < y1; ++row)
+    {
+        uint32_t *dst = &fb->pixels[(size_t)row * (size_t)fb->pitch];
+        for (int col = x0; col < x1; ++col)
+        {
+            dst[col] = pixel;
+        }
+    }
+}
+
+void soft_blit_glyph(Soft_Framebuffer *fb, const Soft_Glyph_Atlas *atlas, int ch, int x, int y, uint32_t color)
+{
+    if (ch < ASCII_DISPLAY_LOW || ch > ASCII_DISPLAY_HIGH)
+    {
+        ch = '?';
+    }
+    if (ch == ' ')
+    {
+        return;
+    }
+
+    const int x0 = x < 0 ? 0 : x;
+    const int x1 = x + atlas->glyph_width > fb->width ? fb->width : x + atlas->glyph_width;
+    const int y0 = y < fb->clip_top ? fb->clip_top : y;
+    const int y1 = y + atlas->glyph_height > fb->clip_bottom ? fb->clip_bottom : y + atlas->glyph_height;
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+
+    const uint8_t *glyph = &atlas->coverage[(size_t)(ch - ASCII_DISPLAY_LOW) * (size_t)atlas->glyph_width * (size_t)atlas->glyph_height];
+    const uint32_t pixel = soft_color(color);
+    for (int row = y0; row < y1; ++row)
+    {
+        soft_blend_span(&fb->pixels[(size_t)row * (size_t)fb->pitch + (size_t)x0],
+                        &glyph[(row - y) * atlas->glyph_width + (x0 - x)],
+                        x1 - x0, pixel);
+    }
+    profiler_count(PROFILER_COUNTER_GLYPHS, 1);
+}
+
+void soft_blit_text_sized(Soft_Framebuffer *fb, const Soft_Glyph_Atlas *atlas, const char *text, size_t text_size, int x, int y, int advance, uint32_t color)
+{
+    for (size_t i = 0; i < text_size; ++i)
+    {
+        soft_blit_glyph(fb, atlas, (unsigned char)text[i], x + (int)i * advance, y, color);
+    }
+}
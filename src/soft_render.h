@@ -0,0 +1,39 @@
+#ifndef SOFT_RENDER_H_
+#define SOFT_RENDER_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// 32 bit 0xAARRGGBB pixels, `pitch` counts pixels. Drawing is clipped to the
+// framebuffer and to the rows [clip_top, clip_bottom).
+typedef struct
+{
+    uint32_t *pixels;
+    int width;
+    int height;
+    int pitch;
+    int clip_top;
+    int clip_bottom;
+} Soft_Framebuffer;
+
+// The bitmap font scaled up once, so every glyph blit is 1:1. Glyph i is
+// glyph_width * glyph_height coverage bytes at i * glyph_width * glyph_height,
+// ASCII_DISPLAY_LOW first.
+typedef struct
+{
+    int glyph_width;
+    int glyph_height;
+    uint8_t *coverage;
+} Soft_Glyph_Atlas;
+
+void soft_glyph_atlas_init(Soft_Glyph_Atlas *atlas, int scale);
+
+void soft_framebuffer_clip(Soft_Framebuffer *fb, int top, int bottom);
+
+// Colors use the same 0xAABBGGRR layout as the other renderers.
+void soft_fill_rect(Soft_Framebuffer *fb, int x, int y, int w, int h, uint32_t color);
+void soft_blit_glyph(Soft_Framebuffer *fb, const Soft_Glyph_Atlas *atlas, int ch, int x, int y, uint32_t color);
+void soft_blit_text_sized(Soft_Framebuffer *fb, const Soft_Glyph_Atlas *atlas, const char *text, size_t text_size, int x, int y, int advance, uint32_t color);
+
+#endif
@@ -0,0 +1,277 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "font.h"
+#include "tile_glyph.h"
+#include "profiler.h"
+
+// Points the instance attributes at the glyphs starting from `first`. GL 3.3
+// has no base instance for instanced draws, so drawing a sub-range of the
+// buffer re-specifies the attribute offsets instead.
+static void tile_glyph_buffer_bind_instances(size_t first)
+{
+    const GLsizei stride = sizeof(Tile_Glyph);
+    const size_t base = first * sizeof(Tile_Glyph);
+
+    glEnableVertexAttribArray(TILE_GLYPH_ATTR_TILE);
+    glVertexAttribIPointer(TILE_GLYPH_ATTR_TILE, 2, GL_INT, stride, (void *)(base + offsetof(Tile_Glyph, tile)));
+    glVertexAttribDivisor(TILE_GLYPH_ATTR_TILE, 1);
+
+    glEnableVertexAttribArray(TILE_GLYPH_ATTR_CH);
+    glVertexAttribIPointer(TILE_GLYPH_ATTR_CH, 1, GL_INT, stride, (void *)(base + offsetof(Tile_Glyph, ch)));
+    glVertexAttribDivisor(TILE_GLYPH_ATTR_CH, 1);
+
+    glEnableVertexAttribArray(TILE_GLYPH_ATTR_FG_COLOR);
+    glVertexAttribPointer(TILE_GLYPH_ATTR_FG_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *)(base + offsetof(Tile_Glyph, fg_color)));
+    glVertexAttribDivisor(TILE_GLYPH_ATTR_FG_COLOR, 1);
+
+    glEnableVertexAttribArray(TILE_GLYPH_ATTR_BG_COLOR);
+    glVertexAttribPointer(TILE_GLYPH_ATTR_BG_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *)(base + offsetof(Tile_Glyph, bg_color)));
+    glVertexAttribDivisor(TILE_GLYPH_ATTR_BG_COLOR, 1);
+}
+
+// Expects the font texture bound to unit 0. The atlas is a grid of
+// `atlas_cols` cells of `atlas_cell_uv` each, ASCII_DISPLAY_LOW first. The
+// glyph is inset by `atlas_pad_uv` on each side of its cell.
+static bool tile_glyph_buffer_init_program(Tile_Glyph_Buffer *buffer, const char *vert_file_path, const char *frag_file_path, int atlas_cols, Vec2f atlas_cell_uv, Vec2f atlas_pad_uv)
+{
+    if (!link_program_files(vert_file_path, frag_file_path, &buffer->program))
+    {
+        return false;
+    }
+
+    glUseProgram(buffer->program);
+    glUniform1i(glGetUniformLocation(buffer->program, "font"), 0);
+    glUniform1i(glGetUniformLocation(buffer->program, "atlas_cols"), atlas_cols);
+    glUniform2f(glGetUniformLocation(buffer->program, "atlas_cell_uv"), atlas_cell_uv.x, atlas_cell_uv.y);
+    glUniform2f(glGetUniformLocation(buffer->program, "atlas_pad_uv"), atlas_pad_uv.x, atlas_pad_uv.y);
+    buffer->resolution_uniform = glGetUniformLocation(buffer->program, "resolution");
+    buffer->camera_uniform = glGetUniformLocation(buffer->program, "camera");
+    buffer->glyph_size_uniform = glGetUniformLocation(buffer->program, "glyph_size");
+
+    glGenVertexArrays(1, &buffer->vao);
+    glBindVertexArray(buffer->vao);
+
+    glGenBuffers(1, &buffer->vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer->vbo);
+    const GLsizeiptr ring_size = (GLsizeiptr)sizeof(buffer->glyphs) * TILE_GLYPH_BUFFER_REGIONS;
+    buffer->mapped = NULL;
+    if (GLEW_ARB_buffer_storage)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, ring_size, NULL, flags);
+        buffer->mapped = (Tile_Glyph *)glMapBufferRange(GL_ARRAY_BUFFER, 0, ring_size, flags);
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, ring_size, NULL, GL_STREAM_DRAW);
+    }
+    buffer->region = 0;
+
+    tile_glyph_buffer_bind_instances(0);
+    buffer->bound_first = 0;
+
+    buffer->count = 0;
+    return true;
+}
+
+bool tile_glyph_buffer_init(Tile_Glyph_Buffer *buffer, const char *vert_file_path, const char *frag_file_path)
+{
+    glActiveTexture(GL_TEXTURE0);
+    load_coverage_texture(font_charmap, FONT_WIDTH, FONT_HEIGHT, &buffer->font_texture);
+
+    return tile_glyph_buffer_init_program(buffer, vert_file_path, frag_file_path, FONT_COLS,
+                                          vec2f((float)FONT_CHAR_WIDTH / FONT_WIDTH, (float)FONT_CHAR_HEIGHT / FONT_HEIGHT), vec2fs(0.0f));
+}
+
+// The distance field is sampled with linear filtering, which is what lets
+// one texture serve every zoom level.
+bool tile_glyph_buffer_init_sdf(Tile_Glyph_Buffer *buffer, const Sdf_Atlas *atlas, const char *vert_file_path, const char *frag_file_path)
+{
+    glActiveTexture(GL_TEXTURE0);
+    load_coverage_texture(atlas->pixels, atlas->width, atlas->height, &buffer->font_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    return tile_glyph_buffer_init_program(buffer, vert_file_path, frag_file_path, atlas->cols,
+                                          vec2f((float)(atlas->cell_width + 2 * SDF_ATLAS_PADDING) / (float)atlas->width,
+                                                (float)(atlas->cell_height + 2 * SDF_ATLAS_PADDING) / (float)atlas->height),
+                                          vec2f((float)SDF_ATLAS_PADDING / (float)atlas->width, (float)SDF_ATLAS_PADDING / (float)atlas->height));
+}
+
+void tile_glyph_buffer_clear(Tile_Glyph_Buffer *buffer)
+{
+    buffer->count = 0;
+}
+
+void tile_glyph_buffer_push(Tile_Glyph_Buffer *buffer, Tile_Glyph glyph)
+{
+    if (buffer->count < TILE_GLYPH_BUFFER_CAP)
+    {
+        buffer->glyphs[buffer->count++] = glyph;
+    }
+}
+
+void tile_glyph_render_line_sized(Tile_Glyph_Buffer *buffer, const char *text, size_t text_size, Vec2i tile, uint32_t fg_color, uint32_t bg_color)
+{
+    for (size_t i = 0; i < text_size; ++i)
+    {
+        tile_glyph_buffer_push(buffer, (Tile_Glyph){
+            .tile = vec2i(tile.x + (int)i, tile.y),
+            .ch = (unsigned char)text[i],
+            .fg_color = fg_color,
+            .bg_color = bg_color,
+        });
+    }
+}
+
+void tile_glyph_buffer_push_run(Tile_Glyph_Buffer *buffer, const Tile_Line_Run *run)
+{
+    size_t count = run->count;
+    if (count > TILE_GLYPH_BUFFER_CAP - buffer->count)
+    {
+        count = TILE_GLYPH_BUFFER_CAP - buffer->count;
+    }
+    memcpy(&buffer->glyphs[buffer->count], run->glyphs, count * sizeof(run->glyphs[0]));
+    buffer->count += count;
+}
+
+// With TILE_GLYPH_BUFFER_REGIONS frames in the ring this normally returns
+// right away, it only blocks when the GPU is that many frames behind.
+static void tile_glyph_buffer_wait_region(Tile_Glyph_Buffer *buffer, size_t region)
+{
+    GLsync fence = buffer->fences[region];
+    if (fence == NULL)
+    {
+        return;
+    }
+
+    GLenum status;
+    do
+    {
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    } while (status == GL_TIMEOUT_EXPIRED);
+    glDeleteSync(fence);
+    buffer->fences[region] = NULL;
+}
+
+// Streams all instances into the next region of the ring. Draws that follow
+// read from that region until the next sync.
+void tile_glyph_buffer_sync(Tile_Glyph_Buffer *buffer)
+{
+    buffer->region = (buffer->region + 1) % TILE_GLYPH_BUFFER_REGIONS;
+    tile_glyph_buffer_wait_region(buffer, buffer->region);
+
+    const size_t size = buffer->count * sizeof(buffer->glyphs[0]);
+    if (size == 0)
+    {
+        return;
+    }
+
+    const size_t first = buffer->region * TILE_GLYPH_BUFFER_CAP;
+    if (buffer->mapped)
+    {
+        memcpy(&buffer->mapped[first], buffer->glyphs, size);
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer->vbo);
+    void *dst = glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)(first * sizeof(buffer->glyphs[0])), (GLsizeiptr)size,
+                                 GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    if (dst != NULL)
+    {
+        memcpy(dst, buffer->glyphs, size);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+}
+
+// Marks the end of the draws reading from the current region, call once
+// per frame after them.
+void tile_glyph_buffer_fence(Tile_Glyph_Buffer *buffer)
+{
+    if (buffer->fences[buffer->region] != NULL)
+    {
+        glDeleteSync(buffer->fences[buffer->region]);
+    }
+    buffer->fences[buffer->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+const Tile_Line_Run *tile_line_cache_get(Tile_Line_Cache *cache, size_t row, uint64_t version, const char *text, size_t text_size, size_t col_begin, size_t col_end, Tile_Line_Cache_Stats *stats)
+{
+    // Widen the window to whole chunks so horizontal scrolling only
+    // rebuilds a run every TILE_LINE_RUN_COL_CHUNK columns.
+    col_begin = col_begin / TILE_LINE_RUN_COL_CHUNK * TILE_LINE_RUN_COL_CHUNK;
+    col_end = (col_end + TILE_LINE_RUN_COL_CHUNK - 1) / TILE_LINE_RUN_COL_CHUNK * TILE_LINE_RUN_COL_CHUNK;
+    if (col_end > text_size)
+    {
+        col_end = text_size;
+    }
+    if (col_begin > col_end)
+    {
+        col_begin = col_end;
+    }
+
+    Tile_Line_Run *run = &cache->runs[row % TILE_LINE_CACHE_CAP];
+    if (run->valid && run->row == row && run->version == version &&
+        run->col_begin == col_begin && run->col_end == col_end)
+    {
+        return run;
+    }
+
+    const size_t count = col_end - col_begin;
+    if (count > run->capacity)
+    {
+        run->glyphs = (Tile_Glyph *)realloc(run->glyphs, count * sizeof(run->glyphs[0]));
+        stats->allocations += 1;
+        assert(run->glyphs != NULL);
+        run->capacity = count;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        run->glyphs[i] = (Tile_Glyph){
+            .tile = vec2i((int)(col_begin + i), (int)row),
+            .ch = (unsigned char)text[col_begin + i],
+            .fg_color = 0xffffffff,
+            .bg_color = 0x00000000,
+        };
+    }
+
+    run->valid = true;
+    run->row = row;
+    run->version = version;
+    run->col_begin = col_begin;
+    run->col_end = col_end;
+    run->count = count;
+    stats->rebuilt = true;
+    return run;
+}
+
+void tile_glyph_buffer_draw(Tile_Glyph_Buffer *buffer, Vec2f resolution, Vec2f camera, Vec2f glyph_size)
+{
+    tile_glyph_buffer_draw_range(buffer, 0, buffer->count, resolution, camera, glyph_size);
+}
+
+void tile_glyph_buffer_draw_range(Tile_Glyph_Buffer *buffer, size_t first, size_t count, Vec2f resolution, Vec2f camera, Vec2f glyph_size)
+{
+    glUseProgram(buffer->program);
+    glUniform2f(buffer->resolution_uniform, resolution.x, resolution.y);
+    glUniform2f(buffer->camera_uniform, camera.x, camera.y);
+    glUniform2f(buffer->glyph_size_uniform, glyph_size.x, glyph_size.y);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, buffer->font_texture);
+    glBindVertexArray(buffer->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer->vbo);
+    first += buffer->region * TILE_GLYPH_BUFFER_CAP;
+    if (first != buffer->bound_first)
+    {
+        tile_glyph_buffer_bind_instances(first);
+        buffer->bound_first = first;
+    }
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)count);
+    profiler_count(PROFILER_COUNTER_DRAW_CALLS, 1);
+    profiler_count(PROFILER_COUNTER_GLYPHS, count);
+}
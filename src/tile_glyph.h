@@ -0,0 +1,109 @@
+#ifndef TILE_GLYPH_H_
+#define TILE_GLYPH_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gl_extra.h"
+#include "la.h"
+#include "sdf_atlas.h"
+
+// One instance of the glyph quad. Colors use the same 0xAABBGGRR layout as
+// the SDL renderer and reach the shader as normalized bytes.
+typedef struct
+{
+    Vec2i tile;
+    int ch;
+    uint32_t fg_color;
+    uint32_t bg_color;
+} Tile_Glyph;
+
+typedef enum
+{
+    TILE_GLYPH_ATTR_TILE = 0,
+    TILE_GLYPH_ATTR_CH,
+    TILE_GLYPH_ATTR_FG_COLOR,
+    TILE_GLYPH_ATTR_BG_COLOR,
+    COUNT_TILE_GLYPH_ATTRS,
+} Tile_Glyph_Attr;
+
+#define TILE_GLYPH_BUFFER_CAP (64 * 1024)
+// The instance VBO is a ring of regions of TILE_GLYPH_BUFFER_CAP glyphs.
+// Every upload goes to the next region, and a region is only written once
+// the fence of the last frame that drew from it has signaled, so uploads
+// neither stall on in-flight draws nor make the driver synchronize.
+#define TILE_GLYPH_BUFFER_REGIONS 3
+
+typedef struct
+{
+    GLuint vao;
+    GLuint vbo;
+    GLuint font_texture;
+    GLuint program;
+
+    GLint resolution_uniform;
+    GLint camera_uniform;
+    GLint glyph_size_uniform;
+
+    // Persistently mapped ring when GL_ARB_buffer_storage is available,
+    // otherwise NULL and each upload maps its region unsynchronized.
+    Tile_Glyph *mapped;
+    size_t region;
+    GLsync fences[TILE_GLYPH_BUFFER_REGIONS];
+
+    // Instance (across the whole ring) the vertex array attributes
+    // currently point at.
+    size_t bound_first;
+
+    size_t count;
+    Tile_Glyph glyphs[TILE_GLYPH_BUFFER_CAP];
+} Tile_Glyph_Buffer;
+
+// Glyph instances of one line, built once and reused while the line version
+// and the (chunk aligned) column window stay the same. Instances carry
+// absolute tile positions and the camera is a uniform, so scrolling never
+// touches them.
+typedef struct
+{
+    bool valid;
+    size_t row;
+    uint64_t version;
+    size_t col_begin;
+    size_t col_end;
+
+    size_t count;
+    size_t capacity;
+    Tile_Glyph *glyphs;
+} Tile_Line_Run;
+
+#define TILE_LINE_CACHE_CAP 1024
+#define TILE_LINE_RUN_COL_CHUNK 64
+
+typedef struct
+{
+    Tile_Line_Run runs[TILE_LINE_CACHE_CAP];
+} Tile_Line_Cache;
+
+// What tile_line_cache_get did, accumulated per caller so runs of different
+// rows can be refreshed from several threads at once.
+typedef struct
+{
+    bool rebuilt;
+    size_t allocations;
+} Tile_Line_Cache_Stats;
+
+bool tile_glyph_buffer_init(Tile_Glyph_Buffer *buffer, const char *vert_file_path, const char *frag_file_path);
+bool tile_glyph_buffer_init_sdf(Tile_Glyph_Buffer *buffer, const Sdf_Atlas *atlas, const char *vert_file_path, const char *frag_file_path);
+void tile_glyph_buffer_clear(Tile_Glyph_Buffer *buffer);
+void tile_glyph_buffer_push(Tile_Glyph_Buffer *buffer, Tile_Glyph glyph);
+void tile_glyph_render_line_sized(Tile_Glyph_Buffer *buffer, const char *text, size_t text_size, Vec2i tile, uint32_t fg_color, uint32_t bg_color);
+void tile_glyph_buffer_push_run(Tile_Glyph_Buffer *buffer, const Tile_Line_Run *run);
+void tile_glyph_buffer_sync(Tile_Glyph_Buffer *buffer);
+void tile_glyph_buffer_fence(Tile_Glyph_Buffer *buffer);
+void tile_glyph_buffer_draw(Tile_Glyph_Buffer *buffer, Vec2f resolution, Vec2f camera, Vec2f glyph_size);
+void tile_glyph_buffer_draw_range(Tile_Glyph_Buffer *buffer, size_t first, size_t count, Vec2f resolution, Vec2f camera, Vec2f glyph_size);
+
+const Tile_Line_Run *tile_line_cache_get(Tile_Line_Cache *cache, size_t row, uint64_t version, const char *text, size_t text_size, size_t col_begin, size_t col_end, Tile_Line_Cache_Stats *stats);
+
+#endif
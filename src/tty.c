@@ -0,0 +1,586 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#endif
+
+#include "tty.h"
+
+// Unchanged cells shorter than this between two changes are sent again
+// rather than jumped over, a cursor move costs about as many bytes.
+#define TTY_GAP_MAX 4
+// Below this many trailing blank cells spaces are cheaper than erasing the
+// rest of the line.
+#define TTY_ERASE_MIN 4
+
+void tty_screen_resize(Tty_Screen *screen, int width, int height)
+{
+    // The cursor needs a cell, and the view follows it by the screen size.
+    width = width > 1 ? width : 1;
+    height = height > 1 ? height : 1;
+
+    const size_t size = (size_t)width * (size_t)height;
+    screen->cells = (char *)realloc(screen->cells, size);
+    screen->shown = (char *)realloc(screen->shown, size);
+    assert(screen->cells != NULL && screen->shown != NULL);
+    memset(screen->cells, ' ', size);
+    memset(screen->shown, ' ', size);
+
+    screen->width = width;
+    screen->height = height;
+    screen->clear = true;
+    screen->scroll = 0;
+}
+
+void tty_screen_free(Tty_Screen *screen)
+{
+    free(screen->cells);
+    free(screen->shown);
+    free(screen->out);
+    *screen = (Tty_Screen){0};
+}
+
+void tty_screen_put_row(Tty_Screen *screen, int y, const char *text, size_t text_size)
+{
+    if (y < 0 || y >= screen->height)
+    {
+        return;
+    }
+
+    char *row = &screen->cells[(size_t)y * (size_t)screen->width];
+    const size_t n = text_size < (size_t)screen->width ? text_size : (size_t)screen->width;
+    memcpy(row, text, n);
+    memset(row + n, ' ', (size_t)screen->width - n);
+}
+
+// Moves the rows of `cells` the way the terminal scrolls: up for positive
+// `rows`, the uncovered rows become blank.
+static void tty_scroll_cells(char *cells, int width, int height, int rows)
+{
+    const int count = rows > 0 ? rows : -rows;
+    if (count >= height)
+    {
+        memset(cells, ' ', (size_t)width * (size_t)height);
+        return;
+    }
+
+    const size_t kept = (size_t)(height - count) * (size_t)width;
+    const size_t moved = (size_t)count * (size_t)width;
+    if (rows > 0)
+    {
+        memmove(cells, cells + moved, kept);
+        memset(cells + kept, ' ', moved);
+    }
+    else
+    {
+        memmove(cells + moved, cells, kept);
+        memset(cells, ' ', moved);
+    }
+}
+
+void tty_screen_scroll(Tty_Screen *screen, int rows)
+{
+    tty_scroll_cells(screen->cells, screen->width, screen->height, rows);
+    screen->scroll += rows;
+}
+
+static void tty_out(Tty_Screen *screen, const char *data, size_t size)
+{
+    if (screen->out_size + size > screen->out_capacity)
+    {
+        size_t capacity = screen->out_capacity > 0 ? screen->out_capacity : 4096;
+        while (screen->out_size + size > capacity)
+        {
+            capacity *= 2;
+        }
+        screen->out = (char *)realloc(screen->out, capacity);
+        assert(screen->out != NULL);
+        screen->out_capacity = capacity;
+    }
+    memcpy(screen->out + screen->out_size, data, size);
+    screen->out_size += size;
+}
+
+static void tty_out_cstr(Tty_Screen *screen, const char *cstr)
+{
+    tty_out(screen, cstr, strlen(cstr));
+}
+
+// Shortest sequence that takes the terminal cursor to (x, y).
+static void tty_move(Tty_Screen *screen, int x, int y)
+{
+    char seq[32];
+    if (screen->at_x == x && screen->at_y == y)
+    {
+        return;
+    }
+    else if (screen->at_y == y && screen->at_x >= 0 && x > screen->at_x)
+    {
+        snprintf(seq, sizeof(seq), "\x1b[%dC", x - screen->at_x);
+    }
+    else if (screen->at_y == y - 1 && screen->at_x >= 0 && x == 0)
+    {
+        snprintf(seq, sizeof(seq), "\r\n");
+    }
+    else
+    {
+        snprintf(seq, sizeof(seq), "\x1b[%d;%dH", y + 1, x + 1);
+    }
+    tty_out_cstr(screen, seq);
+    screen->at_x = x;
+    screen->at_y = y;
+}
+
+// What the terminal does on a scroll: rows move, the uncovered ones are blank.
+static void tty_screen_apply_scroll(Tty_Screen *screen)
+{
+    const int rows = screen->scroll;
+    screen->scroll = 0;
+    if (rows == 0 || screen->clear)
+    {
+        return;
+    }
+    if (rows >= screen->height || -rows >= screen->height)
+    {
+        screen->clear = true;
+        return;
+    }
+
+    char seq[32];
+    snprintf(seq, sizeof(seq), rows > 0 ? "\x1b[%dS" : "\x1b[%dT", rows > 0 ? rows : -rows);
+    tty_out_cstr(screen, seq);
+    tty_scroll_cells(screen->shown, screen->width, screen->height, rows);
+}
+
+static void tty_screen_diff_row(Tty_Screen *screen, int y)
+{
+    const char *now = &screen->cells[(size_t)y * (size_t)screen->width];
+    char *shown = &screen->shown[(size_t)y * (size_t)screen->width];
+    const int width = screen->width;
+
+    // Everything from `blank` on is spaces.
+    int blank = width;
+    while (blank > 0 && now[blank - 1] == ' ')
+    {
+        blank -= 1;
+    }
+
+    int x = 0;
+    while (x < width)
+    {
+        if (now[x] == shown[x])
+        {
+            x += 1;
+            continue;
+        }
+
+        // Extend the run over short unchanged gaps.
+        int end = x + 1;
+        for (int i = end; i < width && i - end <= TTY_GAP_MAX; ++i)
+        {
+            if (now[i] != shown[i])
+            {
+                end = i + 1;
+            }
+        }
+
+        tty_move(screen, x, y);
+        const int text_end = blank > x ? blank : x;
+        if (end - text_end >= TTY_ERASE_MIN)
+        {
+            tty_out(screen, now + x, (size_t)(text_end - x));
+            tty_out_cstr(screen, "\x1b[K");
+            memcpy(shown + x, now + x, (size_t)(width - x));
+            screen->at_x = text_end;
+            x = width;
+        }
+        else
+        {
+            tty_out(screen, now + x, (size_t)(end - x));
+            memcpy(shown + x, now + x, (size_t)(end - x));
+            // Past the last column the terminal is waiting to wrap.
+            screen->at_x = end < width ? end : -1;
+            x = end;
+        }
+    }
+}
+
+static bool tty_write_all(const char *data, size_t size)
+{
+#ifndef _WIN32
+    while (size > 0)
+    {
+        const ssize_t n = write(STDOUT_FILENO, data, size);
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+#else
+    (void)data;
+    (void)size;
+    return false;
+#endif
+}
+
+size_t tty_screen_flush(Tty_Screen *screen)
+{
+    screen->out_size = 0;
+    tty_out_cstr(screen, "\x1b[?25l");
+    const size_t header = screen->out_size;
+
+    tty_screen_apply_scroll(screen);
+    if (screen->clear)
+    {
+        tty_out_cstr(screen, "\x1b[H\x1b[2J");
+        memset(screen->shown, ' ', (size_t)screen->width * (size_t)screen->height);
+        screen->at_x = 0;
+        screen->at_y = 0;
+        screen->clear = false;
+    }
+
+    for (int y = 0; y < screen->height; ++y)
+    {
+        tty_screen_diff_row(screen, y);
+    }
+
+    const bool drawn = screen->out_size > header;
+    if (!drawn)
+    {
+        screen->out_size = 0;
+    }
+    tty_move(screen, screen->cursor_x, screen->cursor_y);
+    if (drawn)
+    {
+        tty_out_cstr(screen, "\x1b[?25h");
+    }
+
+    if (screen->out_size == 0)
+    {
+        return 0;
+    }
+    if (!tty_write_all(screen->out, screen->out_size))
+    {
+        fprintf(stderr, "ERROR: could not write to the terminal: %s\n", strerror(errno));
+        return 0;
+    }
+    return screen->out_size;
+}
+
+#ifndef _WIN32
+
+#define TTY_INPUT_CAP 256
+
+static struct termios tty_saved;
+static bool tty_active = false;
+// SIGWINCH writes a byte to the pipe and tty_wait polls its read end next
+// to stdin, so a resize that arrives just before the poll still wakes it.
+static int tty_resize_pipe[2] = {-1, -1};
+static char tty_input[TTY_INPUT_CAP];
+static size_t tty_input_size = 0;
+
+static void tty_on_resize(int sig)
+{
+    (void)sig;
+    const int saved_errno = errno;
+    const char byte = 0;
+    const ssize_t n = write(tty_resize_pipe[1], &byte, 1);
+    (void)n;
+    errno = saved_errno;
+}
+
+bool tty_begin(void)
+{
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO))
+    {
+        fprintf(stderr, "ERROR: the tty renderer needs a terminal on stdin and stdout\n");
+        return false;
+    }
+    if (tcgetattr(STDIN_FILENO, &tty_saved) < 0)
+    {
+        fprintf(stderr, "ERROR: could not get the terminal attributes: %s\n", strerror(errno));
+        return false;
+    }
+
+    struct termios raw = tty_saved;
+    raw.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+    raw.c_oflag &= ~OPOST;
+    raw.c_cflag |= CS8;
+    raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) < 0)
+    {
+        fprintf(stderr, "ERROR: could not set the terminal attributes: %s\n", strerror(errno));
+        return false;
+    }
+    tty_active = true;
+
+    if (pipe(tty_resize_pipe) < 0)
+    {
+        fprintf(stderr, "ERROR: could not create the resize pipe: %s\n", strerror(errno));
+        tty_end();
+        return false;
+    }
+    for (size_t i = 0; i < 2; ++i)
+    {
+        fcntl(tty_resize_pipe[i], F_SETFL, fcntl(tty_resize_pipe[i], F_GETFL) | O_NONBLOCK);
+        fcntl(tty_resize_pipe[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    struct sigaction action = {0};
+    action.sa_handler = tty_on_resize;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGWINCH, &action, NULL);
+
+    const char *enter = "\x1b[?1049h";
+    tty_write_all(enter, strlen(enter));
+    return true;
+}
+
+void tty_end(void)
+{
+    if (!tty_active)
+    {
+        return;
+    }
+
+    const char *leave = "\x1b[?25h\x1b[?1049l";
+    tty_write_all(leave, strlen(leave));
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &tty_saved);
+    signal(SIGWINCH, SIG_DFL);
+    for (size_t i = 0; i < 2; ++i)
+    {
+        if (tty_resize_pipe[i] >= 0)
+        {
+            close(tty_resize_pipe[i]);
+            tty_resize_pipe[i] = -1;
+        }
+    }
+    tty_active = false;
+}
+
+bool tty_get_size(int *width, int *height)
+{
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) < 0 || size.ws_col == 0)
+    {
+        *width = 80;
+        *height = 24;
+        return false;
+    }
+    *width = size.ws_col;
+    *height = size.ws_row > 0 ? size.ws_row : 1;
+    return true;
+}
+
+bool tty_wait(void)
+{
+    // A full input buffer is not polled, the caller drains it first.
+    struct pollfd fds[2] = {
+        {.fd = tty_input_size < TTY_INPUT_CAP ? STDIN_FILENO : -1, .events = POLLIN},
+        {.fd = tty_resize_pipe[0], .events = POLLIN},
+    };
+    if (poll(fds, 2, tty_input_size < TTY_INPUT_CAP ? -1 : 0) <= 0)
+    {
+        return false;
+    }
+
+    if (fds[0].revents & POLLIN)
+    {
+        const ssize_t n = read(STDIN_FILENO, tty_input + tty_input_size, TTY_INPUT_CAP - tty_input_size);
+        if (n > 0)
+        {
+            tty_input_size += (size_t)n;
+        }
+    }
+
+    bool resized = false;
+    char drain[16];
+    while (read(tty_resize_pipe[0], drain, sizeof(drain)) > 0)
+    {
+        resized = true;
+    }
+    return resized;
+}
+
+#else
+
+bool tty_begin(void)
+{
+    fprintf(stderr, "ERROR: the tty renderer is not supported on this platform\n");
+    return false;
+}
+
+void tty_end(void)
+{
+}
+
+bool tty_get_size(int *width, int *height)
+{
+    *width = 80;
+    *height = 24;
+    return false;
+}
+
+bool tty_wait(void)
+{
+    return false;
+}
+
+static char tty_input[1];
+static size_t tty_input_size = 0;
+
+#endif
+
+typedef struct
+{
+    const char *seq;
+    SDL_Keycode sym;
+} Tty_Key;
+
+// xterm and VT100 (application cursor mode) spellings.
+static const Tty_Key tty_keys[] = {
+    {"\x1b[A", SDLK_UP},
+    {"\x1b[B", SDLK_DOWN},
+    {"\x1b[C", SDLK_RIGHT},
+    {"\x1b[D", SDLK_LEFT},
+    {"\x1bOA", SDLK_UP},
+    {"\x1bOB", SDLK_DOWN},
+    {"\x1bOC", SDLK_RIGHT},
+    {"\x1bOD", SDLK_LEFT},
+    {"\x1b[3~", SDLK_DELETE},
+    {"\x1bOQ", SDLK_F2},
+    {"\x1b[12~", SDLK_F2},
+};
+
+static void tty_consume(size_t size)
+{
+    memmove(tty_input, tty_input + size, tty_input_size - size);
+    tty_input_size -= size;
+}
+
+static void tty_key_event(SDL_Event *event, SDL_Keycode sym)
+{
+    *event = (SDL_Event){0};
+    event->type = SDL_KEYDOWN;
+    event->key.keysym.sym = sym;
+}
+
+bool tty_poll_event(SDL_Event *event)
+{
+    while (tty_input_size > 0)
+    {
+        const unsigned char c = (unsigned char)tty_input[0];
+
+        if (c == 0x1b)
+        {
+            // Input arrives a read at a time, so a lone escape is the key.
+            if (tty_input_size == 1)
+            {
+                tty_consume(1);
+                tty_key_event(event, SDLK_ESCAPE);
+                return true;
+            }
+
+            for (size_t i = 0; i < sizeof(tty_keys) / sizeof(tty_keys[0]); ++i)
+            {
+                const size_t n = strlen(tty_keys[i].seq);
+                if (tty_input_size >= n && memcmp(tty_input, tty_keys[i].seq, n) == 0)
+                {
+                    tty_consume(n);
+                    tty_key_event(event, tty_keys[i].sym);
+                    return true;
+                }
+            }
+
+            // Unknown sequence: skip a CSI up to its final byte, anything
+            // else together with the next byte.
+            size_t n = 2;
+            if (tty_input[1] == '[')
+            {
+                while (n < tty_input_size && (tty_input[n] < 0x40 || tty_input[n] > 0x7e))
+                {
+                    n += 1;
+                }
+                n = n < tty_input_size ? n + 1 : n;
+            }
+            tty_consume(n);
+            continue;
+        }
+
+        switch (c)
+        {
+        case '\r':
+        case '\n':
+            tty_consume(1);
+            tty_key_event(event, SDLK_RETURN);
+            return true;
+        case 0x7f:
+        case 0x08:
+            tty_consume(1);
+            tty_key_event(event, SDLK_BACKSPACE);
+            return true;
+        // Ctrl+S saves, Ctrl+C and Ctrl+Q quit.
+        case 0x13:
+            tty_consume(1);
+            tty_key_event(event, SDLK_F2);
+            return true;
+        case 0x03:
+        case 0x11:
+            tty_consume(1);
+            *event = (SDL_Event){0};
+            event->type = SDL_QUIT;
+            return true;
+        default:
+            break;
+        }
+
+        if (c < 0x20)
+        {
+            tty_consume(1);
+            continue;
+        }
+
+        // A run of text, cut on a UTF-8 lead byte when it does not fit.
+        size_t n = 0;
+        while (n < tty_input_size && n < sizeof(event->text.text) - 1 &&
+               (unsigned char)tty_input[n] >= 0x20 && (unsigned char)tty_input[n] != 0x7f)
+        {
+            n += 1;
+        }
+        if (n < tty_input_size && n == sizeof(event->text.text) - 1)
+        {
+            while (n > 1 && ((unsigned char)tty_input[n] & 0xc0) == 0x80)
+            {
+                n -= 1;
+            }
+        }
+
+        *event = (SDL_Event){0};
+        event->type = SDL_TEXTINPUT;
+        memcpy(event->text.text, tty_input, n);
+        event->text.text[n] = '\0';
+        tty_consume(n);
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,64 @@
+#ifndef TTY_H_
+#define TTY_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+// One byte per cell, row after row. `shown` is what the terminal currently
+// displays, so a flush only sends the cells that differ from `cells`.
+typedef struct
+{
+    int width;
+    int height;
+    char *cells;
+    char *shown;
+
+    // Where the terminal cursor is left after the flush.
+    int cursor_x;
+    int cursor_y;
+
+    // Set by resize: the terminal may have reflowed its contents, so the
+    // next flush clears it first.
+    bool clear;
+    // Rows the contents moved up (down when negative) since the last flush.
+    int scroll;
+
+    // Terminal cursor position while building the output, -1 when unknown.
+    int at_x;
+    int at_y;
+    char *out;
+    size_t out_size;
+    size_t out_capacity;
+} Tty_Screen;
+
+void tty_screen_resize(Tty_Screen *screen, int width, int height);
+void tty_screen_free(Tty_Screen *screen);
+
+// Fills row `y` with `text`, padded with spaces.
+void tty_screen_put_row(Tty_Screen *screen, int y, const char *text, size_t text_size);
+
+// Moves the cells up by `rows` (down when negative), blanking the uncovered
+// rows. The terminal is scrolled the same way with one sequence on the next
+// flush, so scrolling the view only sends the new rows.
+void tty_screen_scroll(Tty_Screen *screen, int rows);
+
+// Sends the changes since the last flush to stdout with a single write.
+// Returns the number of bytes written, 0 when nothing changed.
+size_t tty_screen_flush(Tty_Screen *screen);
+
+// Raw mode and the alternate screen on stdin/stdout, undone by tty_end.
+bool tty_begin(void);
+void tty_end(void);
+bool tty_get_size(int *width, int *height);
+
+// Keys arrive as the SDL events the windowed frontends get: SDL_KEYDOWN for
+// editing keys, SDL_TEXTINPUT for text. Returns false when no complete input
+// is buffered.
+bool tty_poll_event(SDL_Event *event);
+
+// Blocks until there is input or the terminal was resized. Returns true on
+// resize.
+bool tty_wait(void);
+
+#endif
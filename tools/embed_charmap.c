@@ -0,0 +1,63 @@
+// Decodes the bitmap font spritesheet and prints it as C source: the glyph
+// rectangles and one coverage byte per pixel, so te never touches the PNG at
+// runtime. The makefile regenerates src/font_charmap.c with it.
+#include <stdio.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "font.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: embed_charmap <spritesheet.png>\n");
+        return 1;
+    }
+    const char *file_path = argv[1];
+
+    int w, h, n;
+    unsigned char *pixels = stbi_load(file_path, &w, &h, &n, STBI_grey);
+    if (pixels == NULL)
+    {
+        fprintf(stderr, "ERROR: could not load file %s: %s\n", file_path, stbi_failure_reason());
+        return 1;
+    }
+    if (w != FONT_WIDTH || h != FONT_HEIGHT)
+    {
+        fprintf(stderr, "ERROR: %s is %dx%d, font.h expects %dx%d\n", file_path, w, h, FONT_WIDTH, FONT_HEIGHT);
+        return 1;
+    }
+
+    printf("// Generated by tools/embed_charmap.c from %s, do not edit.\n", file_path);
+    printf("#include \"font.h\"\n");
+    printf("\n");
+
+    printf("const Font_Glyph_Rect font_glyph_table[FONT_GLYPH_COUNT] = {\n");
+    for (int index = 0; index < FONT_GLYPH_COUNT; ++index)
+    {
+        printf("    {%d, %d, %d, %d}, // '%c'\n",
+               index % FONT_COLS * FONT_CHAR_WIDTH,
+               index / FONT_COLS * FONT_CHAR_HEIGHT,
+               FONT_CHAR_WIDTH,
+               FONT_CHAR_HEIGHT,
+               index + ASCII_DISPLAY_LOW);
+    }
+    printf("};\n");
+    printf("\n");
+
+    printf("const unsigned char font_charmap[FONT_WIDTH * FONT_HEIGHT] = {");
+    for (int i = 0; i < w * h; ++i)
+    {
+        if (i % 16 == 0)
+        {
+            printf("\n   ");
+        }
+        printf(" 0x%02x,", pixels[i]);
+    }
+    printf("\n};\n");
+
+    stbi_image_free(pixels);
+    return 0;
+}